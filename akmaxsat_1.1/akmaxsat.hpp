@@ -27,16 +27,64 @@
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <string>
-#include <pybind11/pybind11.h>
+#include <thread>
 
 #include "cnf_formula.hpp"
+#include "local_search.hpp"
+#include "qubo_formula.hpp"
+#include "search_control.hpp"
+#include "work_pool.hpp"
 
 using namespace std;
 
-#ifdef RBFS
+//! select the variable to branch on
+/*! The variable maximizing the product of the weights of its two literals
+ * is selected. A scan over all unassigned variables costs no more than the
+ * lower bound computation of a node, which visits each of them as well.
+ *  \param cf the formula
+ *  \param variables the unassigned variables
+ *  \param nvariables number of unassigned variables
+ *  \param sign receives 1 if the positive literal is preferred, -1 otherwise
+ *  \returns the selected variable
+ */
+template <class Formula>
+int branching_variable(const Formula &cf, const int *variables, int nvariables,
+                       int &sign) {
+    assert(nvariables > 0);
+    long double besthvalue = -1;
+    int ind = 0;
+    for (const int *it = variables + nvariables - 1; it >= variables; --it) {
+        long long lneg = cf.getLength(-*it);
+        long long lpos = cf.getLength(*it);
+        long double hv1 = cf.getW_lb(*it) + cf.getBinaryLength(*it) + lpos;
+        assert(hv1 >= 0);
+        long double hv2 = cf.getW_lb(-*it) + cf.getBinaryLength(-*it) + lneg;
+        assert(hv2 >= 0);
+        if (hv1 * hv2 + min(lpos, lneg) >= besthvalue) {
+            besthvalue = hv1 * hv2 + min(lpos, lneg);
+            ind = *it;
+            sign = hv2 > hv1 ? -1 : 1;
+        }
+    }
+    assert(ind != 0);
+    return ind;
+}
 
-void rbfs(CNF_Formula<long long> &cf) {
+//! f-value of a node of rbfs whose literal cannot be assigned, because it
+//! makes the cost reach the weight of the hard clauses; such nodes are never
+//! explored
+const ULL RBFS_INFEASIBLE = MAXWEIGHT;
+
+//! recursive best-first branch and bound, requires Config::bestFirst
+/*! \param cf the formula
+ *  \param control optional early termination control
+ *  \returns false iff the search was stopped by control
+ */
+template <class Config>
+bool rbfs(CNF_Formula<long long, Config> &cf, SearchControl *control = NULL) {
     int *variable_stack = new int[cf.getNVars()];
     int *todo = new int[cf.getNVars()];
     ULL *f = new ULL[cf.getNVars() + 1];
@@ -47,12 +95,12 @@ void rbfs(CNF_Formula<long long> &cf) {
     int *pos = new int[cf.getNVars() + 1];
     int *variables = new int[cf.getNVars()];
     int variable_stack_len = 0;
-    b[0] = MAXWEIGHT;
+    b[0] = RBFS_INFEASIBLE - 1;
     F[0] = f[0] = cf.bestMinusLowerBound();
     int L, p;
     int branch_cnt = 0, propagate_cnt = 0;
-    long double besthvalue;
-    bool found;
+    long long nodes = 0;
+    bool found, assigned;
     vector<pair<long long, int_c> > tv;
     for (int i = 1; i <= cf.getNVars(); ++i) {
         double hv1 =
@@ -71,6 +119,8 @@ void rbfs(CNF_Formula<long long> &cf) {
     }
     int *pit = variables + nvariables - 1;
     do {
+        if (control != NULL && control->poll(nodes++, cf.getBestCost()))
+            break;
         //	printf("%d %llu %llu %llu\n", variable_stack_len,
         // f[variable_stack_len], F[variable_stack_len], b[variable_stack_len]);
         if (f[variable_stack_len] > b[variable_stack_len]) {
@@ -79,29 +129,32 @@ void rbfs(CNF_Formula<long long> &cf) {
         }
         if (variable_stack_len == cf.getNVars()) break;
 
-#ifdef PROP_LIST
-        L = cf.propagateLiteral();
-        if (L != 0) {
-            if (!cf.assignLiteral(L)) goto goback;
-            ++propagate_cnt;
-            variable_stack[variable_stack_len] = abs(L);
-            todo[variable_stack_len++] = 0;
-            F[variable_stack_len] = f[variable_stack_len] =
-                cf.bestMinusLowerBound();
-            b[variable_stack_len] = b[variable_stack_len - 1];
-            if (f[variable_stack_len - 1] < F[variable_stack_len - 1] &&
-                F[variable_stack_len - 1] > F[variable_stack_len])
-                F[variable_stack_len] = F[variable_stack_len - 1];
-            p = pos[abs(L)];
-            assert(p >= 0);
-            if (p != nvariables - 1) {
-                variables[p] = variables[nvariables - 1];
-                pos[variables[p]] = p;
+        if (Config::propList) {
+            L = cf.propagateLiteral();
+            if (L != 0) {
+                if (!cf.assignLiteral(L)) {
+                    F[variable_stack_len] = RBFS_INFEASIBLE;
+                    goto goback;
+                }
+                ++propagate_cnt;
+                variable_stack[variable_stack_len] = abs(L);
+                todo[variable_stack_len++] = 0;
+                F[variable_stack_len] = f[variable_stack_len] =
+                    cf.bestMinusLowerBound();
+                b[variable_stack_len] = b[variable_stack_len - 1];
+                if (f[variable_stack_len - 1] < F[variable_stack_len - 1] &&
+                    F[variable_stack_len - 1] > F[variable_stack_len])
+                    F[variable_stack_len] = F[variable_stack_len - 1];
+                p = pos[abs(L)];
+                assert(p >= 0);
+                if (p != nvariables - 1) {
+                    variables[p] = variables[nvariables - 1];
+                    pos[variables[p]] = p;
+                }
+                --nvariables;
+                continue;
             }
-            --nvariables;
-            continue;
         }
-#endif
 
         found = false;
         if (nvariables < 5000) pit = variables + nvariables - 1;
@@ -111,7 +164,10 @@ void rbfs(CNF_Formula<long long> &cf) {
             long long lpos = cf.getLength(*pit);
             // check if -i can be discarded
             if (cf.getUnitLength(*pit) >= lneg) {
-                if (!cf.assignLiteral(*pit)) goto goback;
+                if (!cf.assignLiteral(*pit)) {
+                    F[variable_stack_len] = RBFS_INFEASIBLE;
+                    goto goback;
+                }
                 assert(pos[*pit] == pit - variables);
                 ++propagate_cnt;
                 variable_stack[variable_stack_len] = *pit;
@@ -130,7 +186,10 @@ void rbfs(CNF_Formula<long long> &cf) {
             }
             // check if +i can be discarded
             else if (cf.getUnitLength(-*pit) >= lpos) {
-                if (!cf.assignLiteral(-*pit)) goto goback;
+                if (!cf.assignLiteral(-*pit)) {
+                    F[variable_stack_len] = RBFS_INFEASIBLE;
+                    goto goback;
+                }
                 assert(pos[*pit] == pit - variables);
                 ++propagate_cnt;
                 variable_stack[variable_stack_len] = *pit;
@@ -149,62 +208,35 @@ void rbfs(CNF_Formula<long long> &cf) {
             }
         }
         if (found) continue;
-        ind = 0;
-        if (nvariables >= 3000) {
-            ind = variables[nvariables - 1];
-            if (cf.getW_lb(ind) + cf.getUnitLength(ind) +
-                    cf.getBinaryLength(ind) >
-                cf.getW_lb(-ind) + cf.getUnitLength(-ind) +
-                    cf.getBinaryLength(-ind))
-                sign = 1;
-            else
-                sign = -1;
-        } else {
-            besthvalue = -1;
-            assert(nvariables > 0);
-            for (int *it = variables + nvariables - 1; it >= variables; --it) {
-                assert(pos[*it] == it - variables);
-                long long lneg = cf.getLength(-*it);
-                long long lpos = cf.getLength(*it);
-                long double hv1 =
-                    cf.getW_lb(*it) + cf.getBinaryLength(*it) + lpos;
-                assert(hv1 >= 0);
-                long double hv2 =
-                    cf.getW_lb(-*it) + cf.getBinaryLength(-*it) + lneg;
-                assert(hv2 >= 0);
-                if (hv1 * hv2 + min(lpos, lneg) >= besthvalue) {
-                    besthvalue = hv1 * hv2 + min(lpos, lneg);
-                    ind = *it;
-                    //		if (lneg > lpos)
-                    if (hv2 > hv1)
-                        sign = -1;
-                    else
-                        sign = 1;
-                }
-            }
-        }
-        assert(ind != 0);
+        ind = branching_variable(cf, variables, nvariables, sign);
         todo[variable_stack_len] = sign * ind;
         variable_stack[variable_stack_len++] = ind;
-        cf.assignLiteral(-sign * ind);
-        F2[variable_stack_len] = f2[variable_stack_len] =
-            cf.bestMinusLowerBound();
-        if (F[variable_stack_len - 1] > f[variable_stack_len - 1] &&
-            F[variable_stack_len - 1] > F2[variable_stack_len])
-            F2[variable_stack_len] = F[variable_stack_len - 1];
-        cf.unassignLiteral();
-        cf.assignLiteral(sign * ind);
-        F[variable_stack_len] = f[variable_stack_len] =
-            cf.bestMinusLowerBound();
-        if (F[variable_stack_len - 1] > f[variable_stack_len - 1] &&
-            F[variable_stack_len - 1] > F[variable_stack_len])
-            F[variable_stack_len] = F[variable_stack_len - 1];
+        F2[variable_stack_len] = f2[variable_stack_len] = RBFS_INFEASIBLE;
+        if (cf.assignLiteral(-sign * ind)) {
+            F2[variable_stack_len] = f2[variable_stack_len] =
+                cf.bestMinusLowerBound();
+            if (F[variable_stack_len - 1] > f[variable_stack_len - 1] &&
+                F[variable_stack_len - 1] > F2[variable_stack_len])
+                F2[variable_stack_len] = F[variable_stack_len - 1];
+            cf.unassignLiteral();
+        }
+        F[variable_stack_len] = f[variable_stack_len] = RBFS_INFEASIBLE;
+        assigned = cf.assignLiteral(sign * ind);
+        if (assigned) {
+            F[variable_stack_len] = f[variable_stack_len] =
+                cf.bestMinusLowerBound();
+            if (F[variable_stack_len - 1] > f[variable_stack_len - 1] &&
+                F[variable_stack_len - 1] > F[variable_stack_len])
+                F[variable_stack_len] = F[variable_stack_len - 1];
+        }
         if (F2[variable_stack_len] < F[variable_stack_len]) {
             todo[variable_stack_len - 1] *= -1;
             swap(F2[variable_stack_len], F[variable_stack_len]);
             swap(f2[variable_stack_len], f[variable_stack_len]);
-            cf.unassignLiteral();
-            cf.assignLiteral(-sign * ind);
+            if (assigned) cf.unassignLiteral();
+            // the literal could be assigned above in the same state
+            assigned = cf.assignLiteral(-sign * ind);
+            assert(assigned);
             ULL temp = cf.bestMinusLowerBound();
             if (temp > f[variable_stack_len]) {
                 if (temp > f2[variable_stack_len])
@@ -218,6 +250,12 @@ void rbfs(CNF_Formula<long long> &cf) {
                 }
             }
         }
+        // if neither literal can be assigned, the node is infeasible
+        if (!assigned) {
+            --variable_stack_len;
+            F[variable_stack_len] = RBFS_INFEASIBLE;
+            goto goback;
+        }
         b[variable_stack_len] =
             min(b[variable_stack_len - 1], F2[variable_stack_len]);
         ++branch_cnt;
@@ -267,7 +305,8 @@ void rbfs(CNF_Formula<long long> &cf) {
             variables[nvariables++] = variable_stack[variable_stack_len];
         }
     } while (variable_stack_len);
-    printf("c %d branches %d propagates\n", branch_cnt, propagate_cnt);
+    cf.context().print("c %d branches %d propagates\n", branch_cnt,
+                       propagate_cnt);
     delete[] variable_stack;
     delete[] todo;
     delete[] F2;
@@ -277,11 +316,37 @@ void rbfs(CNF_Formula<long long> &cf) {
     delete[] b;
     delete[] variables;
     delete[] pos;
+    return control == NULL || !control->interrupted;
 }
 
-#else
+//! SearchStrategy selects between variants of the depth-first search which
+//! explore the same tree in different orders
+struct SearchStrategy {
+    //! branch on the value ranked second by the heuristic first
+    bool flipValues;
+    //! perturb the static variable order with the random number generator
+    //! of the formula, which changes how ties in branching are broken
+    bool shuffleOrder;
+    //! branch on the value of the best assignment found so far first, e.g.
+    //! of an initial assignment given by the user
+    bool guided;
+
+    SearchStrategy() : flipValues(false), shuffleOrder(false), guided(false) {}
+};
 
-void fast_backtrack(CNF_Formula<long long> &cf) {
+//! depth-first branch and bound, requires !Config::bestFirst
+/*! \param cf the formula, a CNF_Formula or a QuboFormula
+ *  \param control optional early termination control
+ *  \param pool optional pool of a parallel search; the subtrees are taken
+ *  from it, and open branches are handed over to it while other workers
+ *  are idle
+ *  \param strategy variant of the search
+ *  \returns false iff the search was stopped by control
+ */
+template <class Formula>
+bool fast_backtrack(Formula &cf, SearchControl *control = NULL,
+                    WorkPool *pool = NULL,
+                    const SearchStrategy &strategy = SearchStrategy()) {
     int *variable_stack = new int[cf.getNVars()];
     int *todo = new int[cf.getNVars()];
     int *pos = new int[cf.getNVars() + 1];
@@ -289,7 +354,7 @@ void fast_backtrack(CNF_Formula<long long> &cf) {
     int variable_stack_len = 0;
     int p;
     int branch_cnt = 0, propagate_cnt = 0;
-    long double besthvalue;
+    long long nodes = 0;
     bool found;
     bool do_lb_calc = false;
     bool firstlb = true;
@@ -300,131 +365,364 @@ void fast_backtrack(CNF_Formula<long long> &cf) {
             cf.getBinaryLength(i) * 2 + cf.getUnitLength(i) + cf.getLength(i);
         double hv2 = cf.getBinaryLength(-i) * 2 + cf.getUnitLength(-i) +
                      cf.getLength(-i);
-        tv.push_back(make_pair(hv1 * hv1 + min(hv1, hv2), i));
+        double hv = hv1 * hv1 + min(hv1, hv2);
+        if (strategy.shuffleOrder)
+            hv *= uniform_real_distribution<double>(0.9, 1.1)(
+                cf.context().rng);
+        tv.push_back(make_pair(hv, i));
     }
     sort(tv.begin(), tv.end());
     int sign = 0;
     int ind;
-    int nvariables = cf.getNVars();
-    for (int i = 0; i < nvariables; ++i) {
-        variables[i] = tv[i].second;
-        pos[tv[i].second] = i;
-    }
-    int *pit = variables + nvariables - 1;
-    do {
-        if (PyErr_CheckSignals() != 0) {
-            throw pybind11::error_already_set();
+    // literals leading to the root of the subtree which is explored
+    vector<int> prefix;
+    bool more = pool == NULL || pool->take(prefix);
+    while (more) {
+        int nvariables = cf.getNVars();
+        for (int i = 0; i < nvariables; ++i) {
+            variables[i] = tv[i].second;
+            pos[tv[i].second] = i;
         }
-
-        if (variable_stack_len == cf.getNVars()) {
-            do_lb_calc = true;
-            goto goback;
+        // assign the prefix; its levels have no open branches
+        int base = 0;
+        for (; base < (int)prefix.size(); ++base) {
+            if (!cf.assignLiteral(prefix[base])) break;
+            variable_stack[base] = abs(prefix[base]);
+            todo[base] = 0;
+            p = pos[variable_stack[base]];
+            variables[p] = variables[nvariables - 1];
+            pos[variables[p]] = p;
+            --nvariables;
         }
+        variable_stack_len = base;
+        int *pit = variables + nvariables - 1;
+        // nothing is left to explore if the prefix exceeds the bound
+        for (bool explore = base == (int)prefix.size(); explore;
+             explore = variable_stack_len > base) {
+            if (control != NULL && control->poll(nodes++, cf.getBestCost()))
+                break;
 
-        firstlb = false;
-        if (!cf.bestMinusLowerBound()) goto goback;
+            if (control != NULL && control->incumbent != NULL)
+                cf.setUpperBound(control->incumbent->share(cf.getBestCost()));
+            // hand the shallowest open branch to an idle worker
+            if (pool != NULL && pool->wantsWork())
+                for (int k = base; k < variable_stack_len; ++k) {
+                    if (!todo[k]) continue;
+                    vector<int> item(k + 1);
+                    for (int i = 0; i < k; ++i)
+                        item[i] = cf.getAssignedLiteral(i);
+                    item[k] = todo[k];
+                    todo[k] = 0;
+                    pool->give(item);
+                    break;
+                }
 
-        found = false;
-        if (nvariables < 5000) pit = variables + nvariables - 1;
-        if (pit >= variables + nvariables) pit = variables + nvariables - 1;
-        for (; pit >= variables; --pit) {
-            long long lneg = cf.getLength(-*pit);
-            long long lpos = cf.getLength(*pit);
-            // check if -i can be discarded
-            if (cf.getUnitLength(*pit) >= lneg) {
-                if (!cf.assignLiteral(*pit)) goto goback;
-                assert(pos[*pit] == pit - variables);
-                ++propagate_cnt;
-                variable_stack[variable_stack_len] = *pit;
-                *pit = variables[nvariables - 1];
-                pos[*pit] = pit - variables;
-                --nvariables;
-                todo[variable_stack_len++] = 0;
-                found = true;
-                break;
-            }
-            // check if +i can be discarded
-            else if (cf.getUnitLength(-*pit) >= lpos) {
-                if (!cf.assignLiteral(-*pit)) goto goback;
-                assert(pos[*pit] == pit - variables);
-                ++propagate_cnt;
-                variable_stack[variable_stack_len] = *pit;
-                *pit = variables[nvariables - 1];
-                pos[*pit] = pit - variables;
-                --nvariables;
-                todo[variable_stack_len++] = 0;
-                found = true;
-                break;
+            if (variable_stack_len == cf.getNVars()) {
+                do_lb_calc = true;
+                goto goback;
             }
-        }
-        if (found) continue;
-        ind = 0;
-        if (nvariables >= 3000) {
-            ind = variables[nvariables - 1];
-            if (cf.getW_lb(ind) + cf.getUnitLength(ind) +
-                    cf.getBinaryLength(ind) >
-                cf.getW_lb(-ind) + cf.getUnitLength(-ind) +
-                    cf.getBinaryLength(-ind))
-                sign = 1;
-            else
-                sign = -1;
-        } else {
-            besthvalue = -1;
-            assert(nvariables > 0);
-            for (int *it = variables + nvariables - 1; it >= variables; --it) {
-                assert(pos[*it] == it - variables);
-                long long lneg = cf.getLength(-*it);
-                long long lpos = cf.getLength(*it);
-                long double hv1 =
-                    cf.getW_lb(*it) + cf.getBinaryLength(*it) + lpos;
-                assert(hv1 >= 0);
-                long double hv2 =
-                    cf.getW_lb(-*it) + cf.getBinaryLength(-*it) + lneg;
-                assert(hv2 >= 0);
-                if (hv1 * hv2 + min(lpos, lneg) >= besthvalue) {
-                    besthvalue = hv1 * hv2 + min(lpos, lneg);
-                    ind = *it;
-
-                    if (hv2 > hv1)
-                        sign = -1;
-                    else
-                        sign = 1;
+
+            firstlb = false;
+            if (!cf.bestMinusLowerBound()) goto goback;
+
+            found = false;
+            if (nvariables < 5000) pit = variables + nvariables - 1;
+            if (pit >= variables + nvariables) pit = variables + nvariables - 1;
+            for (; pit >= variables; --pit) {
+                long long lneg = cf.getLength(-*pit);
+                long long lpos = cf.getLength(*pit);
+                // check if -i can be discarded
+                if (cf.getUnitLength(*pit) >= lneg) {
+                    if (!cf.assignLiteral(*pit)) goto goback;
+                    assert(pos[*pit] == pit - variables);
+                    ++propagate_cnt;
+                    variable_stack[variable_stack_len] = *pit;
+                    *pit = variables[nvariables - 1];
+                    pos[*pit] = pit - variables;
+                    --nvariables;
+                    todo[variable_stack_len++] = 0;
+                    found = true;
+                    break;
+                }
+                // check if +i can be discarded
+                else if (cf.getUnitLength(-*pit) >= lpos) {
+                    if (!cf.assignLiteral(-*pit)) goto goback;
+                    assert(pos[*pit] == pit - variables);
+                    ++propagate_cnt;
+                    variable_stack[variable_stack_len] = *pit;
+                    *pit = variables[nvariables - 1];
+                    pos[*pit] = pit - variables;
+                    --nvariables;
+                    todo[variable_stack_len++] = 0;
+                    found = true;
+                    break;
                 }
             }
-        }
-        assert(ind != 0);
-        todo[variable_stack_len] = -sign * ind;
-        if (!cf.assignLiteral(ind * sign)) {
-            if (!cf.assignLiteral(ind * -sign)) goto goback;
-            todo[variable_stack_len] = 0;
-        }
-        ++branch_cnt;
+            if (found) continue;
+            ind = branching_variable(cf, variables, nvariables, sign);
+            if (strategy.guided && cf.getBestValue(ind) != 0)
+                sign = cf.getBestValue(ind);
+            if (strategy.flipValues) sign = -sign;
+            todo[variable_stack_len] = -sign * ind;
+            if (!cf.assignLiteral(ind * sign)) {
+                if (!cf.assignLiteral(ind * -sign)) goto goback;
+                todo[variable_stack_len] = 0;
+            }
+            ++branch_cnt;
 
-        variable_stack[variable_stack_len++] = ind;
-        p = pos[ind];
-        assert(p >= 0);
-        variables[p] = variables[nvariables - 1];
-        pos[variables[p]] = p;
-        --nvariables;
-        continue;
-    goback:
-        while (variable_stack_len) {
+            variable_stack[variable_stack_len++] = ind;
+            p = pos[ind];
+            assert(p >= 0);
+            variables[p] = variables[nvariables - 1];
+            pos[variables[p]] = p;
+            --nvariables;
+            continue;
+        goback:
+            while (variable_stack_len > base) {
+                --variable_stack_len;
+                cf.unassignLiteral();
+                if (todo[variable_stack_len])
+                    if (cf.assignLiteral(todo[variable_stack_len])) {
+                        todo[variable_stack_len++] = 0;
+                        break;
+                    }
+                pos[variable_stack[variable_stack_len]] = nvariables;
+                variables[nvariables++] = variable_stack[variable_stack_len];
+            }
+        }
+        // return to the root to be ready for the next subtree
+        while (variable_stack_len > 0) {
             --variable_stack_len;
             cf.unassignLiteral();
-            if (todo[variable_stack_len])
-                if (cf.assignLiteral(todo[variable_stack_len])) {
-                    todo[variable_stack_len++] = 0;
-                    break;
-                }
-            pos[variable_stack[variable_stack_len]] = nvariables;
-            variables[nvariables++] = variable_stack[variable_stack_len];
         }
-    } while (variable_stack_len);
-    printf("c %d branches %d propagates\n", branch_cnt, propagate_cnt);
+        more = pool != NULL && (control == NULL || !control->interrupted) &&
+               pool->take(prefix);
+    }
+    cf.context().print("c %d branches %d propagates\n", branch_cnt,
+                       propagate_cnt);
     delete[] variable_stack;
     delete[] todo;
     delete[] variables;
     delete[] pos;
+    return control == NULL || !control->interrupted;
 }
 
-#endif
+//! wait for the end of a concurrent search and enforce control meanwhile
+/*! \param pool the pool of the search
+ *  \param control optional early termination control
+ *  \param nodes number of nodes explored by all searches
+ *  \param incumbent best cost found by all searches
+ */
+inline void supervise(WorkPool &pool, SearchControl *control,
+                      const atomic<long long> &nodes,
+                      const SharedBound &incumbent) {
+    while (!pool.wait(10))
+        if (control != NULL &&
+            control->test(nodes.load(memory_order_relaxed), incumbent.get()))
+            pool.stop();
+}
+
+//! take the formula with the best assignment of a concurrent search
+/*! \param cfs the formulas of the searches
+ *  \param best receives the formula with the best assignment; its lower
+ *  bound is raised to the best lower bound of all formulas
+ */
+template <class Formula>
+void pick_best(vector<unique_ptr<Formula> > &cfs, unique_ptr<Formula> &best) {
+    int w = 0;
+    ULL lb = 0;
+    for (int i = 0; i < (int)cfs.size(); ++i) {
+        if (cfs[i]->getSolutionCost() < cfs[w]->getSolutionCost()) w = i;
+        lb = max(lb, cfs[i]->getLowerBound());
+    }
+    cfs[w]->raiseLowerBound(lb);
+    best = move(cfs[w]);
+}
+
+//! parallel depth-first branch and bound
+/*! every worker builds its own formula from inst and runs fast_backtrack on
+ * the subtrees it takes from a shared WorkPool
+ *  \param inst the formula
+ *  \param nworkers number of worker threads
+ *  \param ctx output sink of the workers; their random number generators
+ *  are seeded from it
+ *  \param control optional early termination control, polled by the
+ *  calling thread only
+ *  \param best receives the formula of the worker which found the best
+ *  assignment
+ *  \param start optional assignment to start from, e.g. found by
+ *  local_search
+ *  \param ub only assignments cheaper than ub are searched for
+ *  \param strategy variant of the search of the workers
+ *  \returns false iff the search was stopped by control
+ */
+template <class Formula>
+bool parallel_backtrack(const WcnfInstance &inst, int nworkers,
+                        SolverContext ctx, SearchControl *control,
+                        unique_ptr<Formula> &best,
+                        const Assignment *start = NULL, ULL ub = MAXWEIGHT,
+                        const SearchStrategy &strategy = SearchStrategy()) {
+    WorkPool pool(nworkers);
+    SharedBound incumbent;
+    atomic<long long> nodes(0);
+    vector<unique_ptr<Formula> > cfs(nworkers);
+    vector<thread> workers;
+    for (int i = 0; i < nworkers; ++i) {
+        SolverContext wctx = ctx.fork();
+        workers.push_back(
+            thread([&pool, &incumbent, &nodes, &inst, &cfs, &strategy, i, wctx,
+                    start, ub]() {
+                cfs[i].reset(new Formula(inst, wctx));
+                if (start != NULL) cfs[i]->saveBest(*start);
+                cfs[i]->setUpperBound(ub);
+                SearchControl wcontrol;
+                wcontrol.cancel_flag = pool.stopFlag();
+                wcontrol.incumbent = &incumbent;
+                wcontrol.node_count = &nodes;
+                fast_backtrack(*cfs[i], &wcontrol, &pool, strategy);
+            }));
+    }
+    supervise(pool, control, nodes, incumbent);
+    for (int i = 0; i < nworkers; ++i) workers[i].join();
+    pick_best(cfs, best);
+    return control == NULL || !control->interrupted;
+}
+
+//! PortfolioMember is one search of a portfolio; it hides the type of its
+//! formula, so that the members can search formulas of different solver
+//! configurations
+class PortfolioMember {
+   public:
+    virtual ~PortfolioMember() {}
+    //! build the formula from inst and search the whole tree
+    /*! \returns false iff the search was stopped by control
+     */
+    virtual bool search(const WcnfInstance &inst, SolverContext ctx,
+                        SearchControl &control, const Assignment *start,
+                        ULL ub, const SearchStrategy &strategy) = 0;
+    virtual ULL getSolutionCost() const = 0;
+    virtual ULL getLowerBound() const = 0;
+    virtual void raiseLowerBound(ULL lb) = 0;
+    virtual ULL getHardWeight() const = 0;
+    virtual vector<int> getSolution() const = 0;
+    virtual void printSolution() const = 0;
+};
+
+//! FormulaMember is a PortfolioMember which searches a Formula depth-first
+template <class Formula>
+class FormulaMember : public PortfolioMember {
+    unique_ptr<Formula> cf;
+
+   public:
+    bool search(const WcnfInstance &inst, SolverContext ctx,
+                SearchControl &control, const Assignment *start, ULL ub,
+                const SearchStrategy &strategy) override {
+        cf.reset(new Formula(inst, ctx));
+        if (start != NULL) cf->saveBest(*start);
+        cf->setUpperBound(ub);
+        return fast_backtrack(*cf, &control, NULL, strategy);
+    }
+    ULL getSolutionCost() const override { return cf->getSolutionCost(); }
+    ULL getLowerBound() const override { return cf->getLowerBound(); }
+    void raiseLowerBound(ULL lb) override { cf->raiseLowerBound(lb); }
+    ULL getHardWeight() const override { return cf->getHardWeight(); }
+    vector<int> getSolution() const override { return cf->getSolution(); }
+    void printSolution() const override { cf->printSolution(); }
+};
+
+//! creates a member of a portfolio
+typedef PortfolioMember *(*MemberFactory)();
+
+//! create a FormulaMember searching a Formula
+template <class Formula>
+PortfolioMember *newMember() {
+    return new FormulaMember<Formula>();
+}
+
+//! portfolio of depth-first searches of different solver configurations
+/*! every member builds its own formula from inst and searches the whole
+ * tree; the members share their best cost as upper bound, and the first
+ * member which completes proves optimality and stops the others. Member i
+ * searches a formula created by configs[i % configs.size()]; members with
+ * the same configuration differ by their strategy.
+ *  \param inst the formula
+ *  \param nmembers number of member threads
+ *  \param configs the factories of the formulas of the members
+ *  \param ctx output sink of the members; their random number generators
+ *  are seeded from it
+ *  \param control optional early termination control, polled by the
+ *  calling thread only
+ *  \param best receives the member which found the best assignment
+ *  \param start optional assignment to start from, e.g. found by
+ *  local_search
+ *  \param ub only assignments cheaper than ub are searched for
+ *  \param base strategy from which the strategies of the members are
+ *  derived
+ *  \returns false iff the search was stopped by control
+ */
+inline bool portfolio_backtrack(const WcnfInstance &inst, int nmembers,
+                                const vector<MemberFactory> &configs,
+                                SolverContext ctx, SearchControl *control,
+                                unique_ptr<PortfolioMember> &best,
+                                const Assignment *start = NULL,
+                                ULL ub = MAXWEIGHT,
+                                const SearchStrategy &base = SearchStrategy()) {
+    // the members take no items, the pool only serves to stop them
+    WorkPool pool(nmembers);
+    SharedBound incumbent;
+    atomic<long long> nodes(0);
+    vector<unique_ptr<PortfolioMember> > cfs(nmembers);
+    vector<thread> members;
+    int nconfigs = (int)configs.size();
+    for (int i = 0; i < nmembers; ++i) {
+        cfs[i].reset(configs[i % nconfigs]());
+        // the configurations come first; members which repeat one flip the
+        // values and then perturb the variable order to break ties
+        // differently
+        int round = i / nconfigs;
+        SearchStrategy strategy = base;
+        strategy.flipValues = round % 2 == 1;
+        strategy.shuffleOrder = round >= 2;
+        SolverContext mctx = ctx.fork();
+        members.push_back(thread([&pool, &incumbent, &nodes, &inst, &cfs, i,
+                                  strategy, mctx, start, ub]() {
+            SearchControl mcontrol;
+            mcontrol.cancel_flag = pool.stopFlag();
+            mcontrol.incumbent = &incumbent;
+            mcontrol.node_count = &nodes;
+            if (cfs[i]->search(inst, mctx, mcontrol, start, ub, strategy))
+                pool.stop();
+        }));
+    }
+    supervise(pool, control, nodes, incumbent);
+    for (int i = 0; i < nmembers; ++i) members[i].join();
+    pick_best(cfs, best);
+    return control == NULL || !control->interrupted;
+}
+
+//! sequential branch and bound with the search selected by Config
+/*! \param cf the formula
+ *  \param control optional early termination control
+ *  \param strategy variant of the depth-first search
+ *  \returns false iff the search was stopped by control
+ */
+template <class Config>
+bool backtrack(CNF_Formula<long long, Config> &cf,
+               SearchControl *control = NULL,
+               const SearchStrategy &strategy = SearchStrategy()) {
+    if (Config::bestFirst) return rbfs(cf, control);
+    return fast_backtrack(cf, control, NULL, strategy);
+}
+
+//! sequential depth-first branch and bound of a formula of unit and binary
+//! clauses
+/*! \param cf the formula
+ *  \param control optional early termination control
+ *  \param strategy variant of the depth-first search
+ *  \returns false iff the search was stopped by control
+ */
+template <class Config>
+bool backtrack(QuboFormula<Config> &cf, SearchControl *control = NULL,
+               const SearchStrategy &strategy = SearchStrategy()) {
+    return fast_backtrack(cf, control, NULL, strategy);
+}
@@ -0,0 +1,246 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BINARY_INSTANCE_HPP_INCLUDE
+#define BINARY_INSTANCE_HPP_INCLUDE
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "compressed_input.hpp"
+#include "wcnf_instance.hpp"
+
+using namespace std;
+
+/*! \file binary_instance.hpp Documentation of struct BinaryHeader
+ */
+//! BinaryHeader starts a WcnfInstance saved in binary format
+/*! The fields are stored one after another without padding, followed by
+ * the weights of the clauses as 64-bit integers, their lengths and then
+ * their literals as 32-bit integers. All numbers are stored in little-endian
+ * byte order. The arrays are aligned for their types, so that they can be
+ * copied directly from a file mapped into memory.
+ */
+struct BinaryHeader {
+    //! BINARY_MAGIC
+    char magic[8];
+    //! BINARY_VERSION
+    uint32_t version;
+    //! WcnfInstance::weighted
+    uint32_t weighted;
+    //! WcnfInstance::maxVn
+    uint64_t maxVn;
+    //! WcnfInstance::hard
+    uint64_t hard;
+    //! number of clauses
+    uint64_t nClauses;
+    //! number of literals of all clauses
+    uint64_t nLiterals;
+};
+
+//! first bytes of a file in binary format
+static const char BINARY_MAGIC[8] = {'A', 'K', 'M', 'S', 'B', 'I', 'N', 0};
+//! version of the binary format, increased when the layout changes
+static const uint32_t BINARY_VERSION = 1;
+//! size of BinaryHeader in a file
+static const size_t BINARY_HEADER_SIZE = 8 + 2 * 4 + 4 * 8;
+
+//! check if numbers are stored in little-endian byte order
+inline bool littleEndian() {
+    const uint16_t one = 1;
+    return *(const unsigned char *)&one == 1;
+}
+
+//! reverse the byte order of the numbers in an array
+template <class T>
+inline void swapBytes(T *a, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char *b = (unsigned char *)&a[i];
+        reverse(b, b + sizeof(T));
+    }
+}
+
+//! write an array of numbers in little-endian byte order
+template <class T>
+inline void writeLittleEndian(ostream &ostr, const T *a, size_t n) {
+    if (littleEndian()) {
+        ostr.write((const char *)a, n * sizeof(T));
+        return;
+    }
+    vector<T> swapped(a, a + n);
+    swapBytes(swapped.data(), n);
+    ostr.write((const char *)swapped.data(), n * sizeof(T));
+}
+
+//! write a number in little-endian byte order
+template <class T>
+inline void writeField(ostream &ostr, T x) {
+    writeLittleEndian(ostr, &x, 1);
+}
+
+//! read a number in little-endian byte order
+/*! \param p the position of the number, which need not be aligned for T;
+ *  it is moved behind it
+ */
+template <class T>
+inline void readField(const char *&p, T &x) {
+    memcpy(&x, p, sizeof(x));
+    if (!littleEndian()) swapBytes(&x, 1);
+    p += sizeof(x);
+}
+
+//! read an array of numbers in little-endian byte order
+/*! \param p the start of the array, aligned for T; it is moved behind it
+ */
+template <class T>
+inline void readLittleEndian(const char *&p, vector<T> &a, size_t n) {
+    a.assign((const T *)p, (const T *)p + n);
+    if (!littleEndian()) swapBytes(a.data(), n);
+    p += n * sizeof(T);
+}
+
+//! write a formula in binary format
+/*! \param ostr the output stream, opened in binary mode
+ *  \param inst the formula to be written
+ */
+inline void writeBinary(ostream &ostr, const WcnfInstance &inst) {
+    ostr.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    writeField(ostr, BINARY_VERSION);
+    writeField(ostr, (uint32_t)inst.weighted);
+    writeField(ostr, (uint64_t)inst.maxVn);
+    writeField(ostr, (uint64_t)inst.hard);
+    writeField(ostr, (uint64_t)inst.nClauses());
+    writeField(ostr, (uint64_t)inst.literals.size());
+    writeLittleEndian(ostr, inst.weights.data(), inst.weights.size());
+    writeLittleEndian(ostr, inst.lengths.data(), inst.lengths.size());
+    writeLittleEndian(ostr, inst.literals.data(), inst.literals.size());
+}
+
+//! save a formula in binary format
+/*! \param filename the name of the file
+ *  \param inst the formula to be saved
+ *  \returns false if the file cannot be written
+ */
+inline bool saveBinary(const string &filename, const WcnfInstance &inst) {
+    ofstream ostr(filename.c_str(), ios::binary);
+    if (ostr) writeBinary(ostr, inst);
+    return (bool)ostr;
+}
+
+//! check if a file starts with BINARY_MAGIC
+inline bool isBinaryFile(const string &filename) {
+    char magic[sizeof(BINARY_MAGIC)];
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == NULL) return false;
+    bool binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                  !memcmp(magic, BINARY_MAGIC, sizeof(magic));
+    fclose(file);
+    return binary;
+}
+
+//! read a formula in binary format from memory
+/*! \param data the contents of the file, aligned for 64-bit integers
+ *  \param size the size of the file
+ *  \param inst receives the formula
+ *  \returns false if the data is not a valid formula in binary format
+ */
+inline bool readBinary(const char *data, size_t size, WcnfInstance &inst) {
+    BinaryHeader h;
+    if (size < BINARY_HEADER_SIZE) return false;
+    const char *p = data;
+    memcpy(h.magic, p, sizeof(h.magic));
+    p += sizeof(h.magic);
+    readField(p, h.version);
+    readField(p, h.weighted);
+    readField(p, h.maxVn);
+    readField(p, h.hard);
+    readField(p, h.nClauses);
+    readField(p, h.nLiterals);
+    size -= BINARY_HEADER_SIZE;
+    if (memcmp(h.magic, BINARY_MAGIC, sizeof(h.magic)) ||
+        h.version != BINARY_VERSION || h.maxVn > INT_MAX ||
+        h.nClauses > INT_MAX || h.nLiterals > size / sizeof(int_c) ||
+        size != h.nClauses * (sizeof(ULL) + sizeof(int)) +
+                    h.nLiterals * sizeof(int_c))
+        return false;
+    inst.maxVn = (int)h.maxVn;
+    inst.hard = h.hard;
+    inst.weighted = h.weighted != 0;
+    readLittleEndian(p, inst.weights, h.nClauses);
+    readLittleEndian(p, inst.lengths, h.nClauses);
+    readLittleEndian(p, inst.literals, h.nLiterals);
+    // the checks of WcnfInstance::addClause and DimacsParser::finish
+    uint64_t total = 0;
+    ULL soft = 0;
+    for (size_t i = 0; i < h.nClauses; ++i) {
+        ULL w = inst.weights[i];
+        if (inst.lengths[i] < 0 || w == 0 || w > MAXWEIGHT) return false;
+        total += inst.lengths[i];
+        if (!inst.hard || w < inst.hard) soft += min(w, MAXWEIGHT - soft);
+    }
+    if (total != h.nLiterals || soft >= MAXWEIGHT) return false;
+    for (size_t i = 0; i < h.nLiterals; ++i)
+        if (inst.literals[i] == 0 || inst.literals[i] < -inst.maxVn ||
+            inst.literals[i] > inst.maxVn)
+            return false;
+    return true;
+}
+
+//! load a formula in binary format by mapping the file into memory
+/*! \param filename the name of the file
+ *  \param inst receives the formula
+ *  \returns false if the file cannot be read or is not valid
+ */
+inline bool loadBinary(const string &filename, WcnfInstance &inst) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    bool loaded = data != MAP_FAILED &&
+                  readBinary((const char *)data, st.st_size, inst);
+    if (data != MAP_FAILED) munmap(data, st.st_size);
+    return loaded;
+}
+
+//! read a formula from a file in binary format or in DIMACS cnf/wcnf format,
+//! which may be compressed with gzip or xz
+/*! \param filename the name of the file
+ *  \param inst receives the clauses
+ *  \returns false if the file cannot be read or on a parse error
+ */
+inline bool readInstanceFile(const string &filename, WcnfInstance &inst) {
+    if (isBinaryFile(filename)) return loadBinary(filename, inst);
+    return readDimacsInput(filename, inst);
+}
+
+#endif
@@ -24,33 +24,50 @@
 
 #include <algorithm>
 #include <iostream>
+#include <vector>
 
 using namespace std;
 
 typedef int int_c;
 typedef unsigned long long ULL;
 
-ULL MAXWEIGHT = (1ULL << 63) - 1;
+const ULL MAXWEIGHT = (1ULL << 63) - 1;
 
 /*! \file clauses.hpp Documentation of class Clauses
  */
 //! The class Clauses is a data structure which stores and maintains a list of
 //! clauses efficiently
+/*! The clause headers are stored as parallel arrays indexed by the clause id:
+ * the length and flags, the current weight, the saved weight and the
+ * position of the literals. The literals are stored in chunks which never
+ * move, so the storage grows without copying and is not limited by the range
+ * of int; the blocks of deleted clauses are reused by later clauses.
+ */
 class Clauses {
     // private member variable
-    //! clauses contains clauses in the format \<length\> <traversal id>
-    //! \<literal 1\> ... \<literal length\>
-    int_c *clauses;
-    //! capacity of the array clauses - a power of 2
-    int capacity;
-    //! capacity of the array headsFreeList - log2(capacity)
-    int logcapacity;
-    //! pointers to the first free block of size 2^i
-    int *headsFreeList;
+    //! length and flags of each clause; mutable since getLiterals records
+    //! that it has moved the unassigned literals to the front
+    mutable vector<int> header;
+    //! current weight of each clause
+    vector<ULL> weight;
+    //! saved weight of each clause
+    vector<ULL> savedWeight;
+    //! literals of each clause
+    vector<int_c *> literals;
+    //! number of literals which fit into the block of each clause
+    vector<int> blockSize;
+    //! ids of the deleted clauses whose blocks hold at least 2^i literals
+    vector<vector<int> > freeIds;
+    //! chunks storing the literals
+    vector<int_c *> chunks;
+    //! number of literals used in the last chunk
+    size_t chunkUsed;
     //! stores which literals are currently assigned to false
     bool *assigned;
     //! number of variables
     int nVars;
+    //! number of literals in a chunk
+    const static size_t CHUNK_SIZE = 1 << 20;
     //! bit which indicates deletion of the clause
     const static int DELETED = 1 << 30;
     //! bit which indicates a marker
@@ -64,69 +81,49 @@ class Clauses {
     const static int MAXLEN = (1 << 27) - 1;
 
     // private functions
-    //! doubles the amount of memory available to store clauses
-    void doubleStorage() {
-        capacity <<= 1;
-        ++logcapacity;
-        int_c *clauses2 = new int_c[capacity];
-        assert(clauses2 != NULL);
-        memcpy(clauses2, clauses, sizeof(int_c) * capacity / 2);
-        delete[] clauses;
-        clauses = clauses2;
-        int *headsFreeList2 = new int[logcapacity];
-        assert(headsFreeList2 != NULL);
-        memcpy(headsFreeList2, headsFreeList, sizeof(int) * (logcapacity - 1));
-        delete[] headsFreeList;
-        headsFreeList = headsFreeList2;
-        assert(headsFreeList[logcapacity - 2] == 0);
-        // add the new storage block to the buddy memory management
-        headsFreeList[logcapacity - 2] = capacity / 2;
-        headsFreeList[logcapacity - 1] = 0;
-        clauses[capacity / 2] = 0;
-    }
-
-    //! add a free memory block of size 2^list_id to the list of empty blocks
-    void addFreeBlock(int pos, int list_id) {
-        clauses[pos] = headsFreeList[list_id];
-        headsFreeList[list_id] = pos;
+    //! check if clause_id is the id of a clause
+    inline bool isClause(int clause_id) const {
+        return clause_id > 1 && clause_id < (int)header.size();
     }
-    //! remove the first block of size 2^list_id from the list of empty blocks
-    void popFreeBlock(int list_id) {
-        assert(headsFreeList[list_id] > 0);
-        headsFreeList[list_id] = clauses[headsFreeList[list_id]];
+    //! get a block for size literals from the last chunk
+    int_c *allocateBlock(size_t size) {
+        if (chunks.empty() || chunkUsed + size > CHUNK_SIZE) {
+            // a clause longer than a chunk gets a chunk of its own
+            size_t chunkSize = CHUNK_SIZE;
+            chunks.push_back(new int_c[max(size, chunkSize)]);
+            chunkUsed = 0;
+        }
+        int_c *block = chunks.back() + chunkUsed;
+        chunkUsed += size;
+        return block;
     }
     //! add special flag to clause
     /*! \param clause_id The id of the clause to which a special flag should be
      * added
      */
     void addSpecialFlag2Clause(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
-               clauses[clause_id] > 0 && (clauses[clause_id] & SPECIAL) == 0);
-        clauses[clause_id] |= SPECIAL;
+        assert(isClause(clause_id) && header[clause_id] > 0 &&
+               (header[clause_id] & SPECIAL) == 0);
+        header[clause_id] |= SPECIAL;
     }
 
     // public functions
    public:
     //! Clauses constructor
-    Clauses() {
-        assigned = NULL;
-        logcapacity = 16;
-        capacity = 1 << logcapacity;
-        clauses = new int_c[capacity];
-        headsFreeList = new int[logcapacity];
-        for (int i = 0; i + 1 < logcapacity; ++i) {
-            headsFreeList[i] = 1 << i;
-            clauses[1 << i] = 0;
-        }
-        headsFreeList[logcapacity - 1] = 0;
+    Clauses() : freeIds(32), chunkUsed(0), assigned(NULL) {
+        // the ids 0 and 1 are not used for clauses
+        header.resize(2, 0);
+        weight.resize(2, 0);
+        savedWeight.resize(2, 0);
+        literals.resize(2, NULL);
+        blockSize.resize(2, 0);
     }
 
     ~Clauses() {
-        delete[] clauses;
+        for (size_t i = 0; i < chunks.size(); ++i) delete[] chunks[i];
         assert(assigned != NULL);
         assigned -= nVars;
         delete[] assigned;
-        delete[] headsFreeList;
     }
 
     //! initialize the number of variables and the assigned array
@@ -137,6 +134,14 @@ class Clauses {
         memset(assigned, false, (2 * nVars + 1) * sizeof(bool));
         assigned += nVars;
     }
+    //! reserve space for the headers of n clauses
+    void reserve(int n) {
+        header.reserve(n + 2);
+        weight.reserve(n + 2);
+        savedWeight.reserve(n + 2);
+        literals.reserve(n + 2);
+        blockSize.reserve(n + 2);
+    }
     //! Add a clause to the list of clauses.
     /*! \param literals specifies the literals of the clause
      *  \param length gives the length of the clause
@@ -145,38 +150,29 @@ class Clauses {
      */
     int addClause(int_c *literals, int length, ULL weight) {
         assert(literals != NULL && length >= 0 && length <= MAXLEN);
-        // find a free block for storing the new clause
-        int pos = 0, k;
-        length += 5;
-        for (k = 2; k < logcapacity; ++k)
-            if ((1 << k) >= length) {
-                pos = headsFreeList[k];
-                if (pos) break;
+        // reuse the id and the block of a deleted clause if one is large
+        // enough; the block sizes of list k are at least 2^k
+        int id = 0, k = 0;
+        while ((1 << k) < max(length, 1)) ++k;
+        for (; k < (int)freeIds.size() && !id; ++k)
+            if (!freeIds[k].empty()) {
+                id = freeIds[k].back();
+                freeIds[k].pop_back();
             }
-        // increase storage as long as no large enough block was found
-        while (!pos) {
-            doubleStorage();
-            // after doubling storage, the biggest available block has size
-            // 2^(logcapacity-2)
-            if ((1 << (logcapacity - 2)) >= length) {
-                pos = headsFreeList[logcapacity - 2];
-                assert(pos);
-                k = logcapacity - 2;
-                break;
-            }
-        }
-        popFreeBlock(k);
-        // now split the block until its size is the smallest power of 2 >=
-        // length
-        while (k > 0 && (1 << (k - 1)) >= length) {
-            --k;
-            addFreeBlock(pos + (1 << k), k);
+        if (!id) {
+            // a block of at least one literal holds the reference counter
+            id = (int)header.size();
+            int size = max(length, 1);
+            header.push_back(0);
+            this->weight.push_back(0);
+            savedWeight.push_back(0);
+            this->literals.push_back(allocateBlock(size));
+            blockSize.push_back(size);
         }
-        length -= 5;
-        clauses[pos] = length;
-        *((ULL *)&clauses[pos + 1]) = *((ULL *)&clauses[pos + 3]) = weight;
-        memcpy(clauses + pos + 5, literals, sizeof(int_c) * length);
-        return pos;
+        header[id] = length;
+        this->weight[id] = savedWeight[id] = weight;
+        memcpy(this->literals[id], literals, sizeof(int_c) * length);
+        return id;
     }
     //! lit is assigned to false
     /*! \param lit is the literal which is assigned false
@@ -191,128 +187,132 @@ class Clauses {
     /*! \param clause_id is the id of the clause whose length is decreased
      */
     void decreaseLength(int clause_id) {
-        clauses[clause_id] = (clauses[clause_id] | CHANGED) - 1;
+        header[clause_id] = (header[clause_id] | CHANGED) - 1;
     }
     //! increase the length of a clause because of an assignment
     /*! \param clause_id is the id of the clause whose length is increased
      */
     void increaseLength(int clause_id) {
-        clauses[clause_id] = (clauses[clause_id] | CHANGED) + 1;
+        header[clause_id] = (header[clause_id] | CHANGED) + 1;
     }
     //! Delete clause clause_id.
     /*! \param clause_id The id of the clause to be deleted.
      */
     void deleteClause(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
-               (clauses[clause_id] & DELETED) == DELETED &&
-               (clauses[clause_id] & SPECIAL) == SPECIAL);
-        int k = 2, w = getLength(clause_id) + 5;
-        while ((1 << k) < w) ++k;
-        addFreeBlock(clause_id, k);
+        assert(isClause(clause_id) &&
+               (header[clause_id] & DELETED) == DELETED &&
+               (header[clause_id] & SPECIAL) == SPECIAL);
+        // the block is reused by clauses with at most 2^k literals
+        int k = 0;
+        while ((2 << k) <= blockSize[clause_id]) ++k;
+        header[clause_id] = 0;
+        freeIds[k].push_back(clause_id);
     }
     //! prepare a clause for deletion
     /*! \param clause_id The id of the clause.
      *  \remark add a reference counter
      */
     void prepareDelete(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity);
-        assert(clauses[clause_id + 1] == 0);
+        assert(isClause(clause_id));
+        assert(weight[clause_id] == 0);
         addSpecialFlag2Clause(clause_id);
-        clauses[clause_id + 5] = getLength(clause_id);
+        // the literals are not needed anymore, so the first one is replaced
+        // by the counter
+        literals[clause_id][0] = getLength(clause_id);
     }
     //! decrease reference counter
     /*! \param clause_id The id of the clause.
      */
     void decreaseCounter(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
-               (clauses[clause_id] & DELETED) == DELETED &&
-               (clauses[clause_id] & SPECIAL) == SPECIAL);
-        if (--clauses[clause_id + 5] == 0) deleteClause(clause_id);
+        assert(isClause(clause_id) &&
+               (header[clause_id] & DELETED) == DELETED &&
+               (header[clause_id] & SPECIAL) == SPECIAL);
+        if (--literals[clause_id][0] == 0) deleteClause(clause_id);
     }
     //! Add a delete flag to a clause.
     /*! \param clause_id The id of the clause to be flagged
      */
     void addDeleteFlag2Clause(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
-               (clauses[clause_id] & DELETED) == 0);
-        clauses[clause_id] |= DELETED;
+        assert(isClause(clause_id) &&
+               (header[clause_id] & DELETED) == 0);
+        header[clause_id] |= DELETED;
     }
     //! mark the clause.
     /*! \param clause_id The id of the clause to be marked
      */
     void addMarker2Clause(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
-               clauses[clause_id] > 0 && (clauses[clause_id] & MARKED) == 0);
-        clauses[clause_id] |= MARKED;
+        assert(isClause(clause_id) &&
+               header[clause_id] > 0 && (header[clause_id] & MARKED) == 0);
+        header[clause_id] |= MARKED;
     }
     //! remove the special flag from a clause
     /*! \param clause_id The id of the clause
      */
     void removeSpecialFlagFromClause(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
-               clauses[clause_id] > 0 && (clauses[clause_id] & SPECIAL));
-        clauses[clause_id] ^= SPECIAL;
+        assert(isClause(clause_id) &&
+               header[clause_id] > 0 && (header[clause_id] & SPECIAL));
+        header[clause_id] ^= SPECIAL;
     }
     //! Remove marker from a clause.
     /*! \param clause_id The id of the clause.
      */
     void removeMarkerFromClause(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
-               clauses[clause_id] > 0 && (clauses[clause_id] & MARKED));
-        clauses[clause_id] ^= MARKED;
+        assert(isClause(clause_id) &&
+               header[clause_id] > 0 && (header[clause_id] & MARKED));
+        header[clause_id] ^= MARKED;
     }
     //! Remove a delete flag from a clause.
     /*! \param clause_id The id of the clause.
      */
     void removeDeleteFlagFromClause(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
-               (clauses[clause_id] & DELETED));
-        clauses[clause_id] ^= DELETED;
+        assert(isClause(clause_id) &&
+               (header[clause_id] & DELETED));
+        header[clause_id] ^= DELETED;
     }
     //! Get the delete flag of a clause.
     /*! \param clause_id The id of the clause
      *  \returns true if clause is marked as deleted, false otherwise
      */
     bool getDeleteFlag(int clause_id) const {
-        assert(clause_id > 0 && clause_id < capacity &&
-               clauses[clause_id] != 0);
-        return clauses[clause_id] & DELETED;
+        assert(isClause(clause_id) &&
+               header[clause_id] != 0);
+        return header[clause_id] & DELETED;
     }
     //! Get the marker of a clause.
     /*! \param clause_id The id of the clause
      *  \returns true if clause is marked, false otherwise
      */
     bool getMarker(int clause_id) const {
-        assert(clause_id > 0 && clause_id < capacity &&
-               clauses[clause_id] != 0);
-        return clauses[clause_id] & MARKED;
+        assert(isClause(clause_id) &&
+               header[clause_id] != 0);
+        return header[clause_id] & MARKED;
     }
     //! Get the special flag of a clause.
     /*! \param clause_id The id of the clause
      *  \returns true if clause is flagged as special, false otherwise
      */
     bool getSpecialFlag(int clause_id) const {
-        assert(clause_id > 0 && clause_id < capacity &&
-               clauses[clause_id] != 0);
-        return clauses[clause_id] & SPECIAL;
+        assert(isClause(clause_id) &&
+               header[clause_id] != 0);
+        return header[clause_id] & SPECIAL;
     }
     //! Get a list of literals of a clause.
     /*! \param clause_id The id of the clause.
      */
     const int_c *getLiterals(int clause_id) const {
-        assert(clause_id > 0 && clause_id < capacity);
+        assert(isClause(clause_id));
         // check if clause length has changed
-        if (clauses[clause_id] & CHANGED) {
+        if (header[clause_id] & CHANGED) {
             // move the unassigned literals to the front
-            clauses[clause_id] ^= CHANGED;
+            header[clause_id] ^= CHANGED;
             int needed = getLength(clause_id);
-            int *sptr = clauses + clause_id + 5;
+            int_c *sptr = literals[clause_id];
             while (needed && !assigned[*sptr]) {
                 ++sptr;
                 --needed;
             }
-            if (!needed) return clauses + clause_id + 5;
-            int *ptr = sptr + 1;
+            if (!needed) return literals[clause_id];
+            int_c *ptr = sptr + 1;
             int c = needed;
             while (needed) {
                 if (!assigned[*ptr++]) --needed;
@@ -330,83 +330,83 @@ class Clauses {
                 }
             }
         }
-        return clauses + clause_id + 5;
+        return literals[clause_id];
     }
     //! get the length of a clause.
     /*! \param clause_id The id of the clause.
      *  \returns the length of the clause
      */
     int getLength(int clause_id) const {
-        assert(clause_id > 0 && clause_id < capacity &&
-               clauses[clause_id] != 0);
-        return clauses[clause_id] & MAXLEN;
+        assert(isClause(clause_id) &&
+               header[clause_id] != 0);
+        return header[clause_id] & MAXLEN;
     }
     //! get the weight of a clause.
     /*! \param clause_id The id of the clause.
      *  \returns the weight of the clause
      */
     ULL getWeight(int clause_id) const {
-        assert(clause_id > 0 && clause_id < capacity);
-        return *((ULL *)&clauses[clause_id + 1]);
+        assert(isClause(clause_id));
+        return weight[clause_id];
     }
     //! get the saved weight of a clause.
     /*! \param clause_id The id of the clause.
      *  \returns the weight of the clause
      */
     ULL getSavedWeight(int clause_id) const {
-        assert(clause_id > 0 && clause_id < capacity &&
+        assert(isClause(clause_id) &&
                getLength(clause_id) > 0);
-        return *((ULL *)&clauses[clause_id + 3]);
+        return savedWeight[clause_id];
     }
     //! reset the weight of a clause to the saved weight.
     /*! \param clause_id The id of the clause.
      */
     void resetWeight(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
+        assert(isClause(clause_id) &&
                getLength(clause_id) > 0);
         assert(!getSpecialFlag(clause_id));
         if (getWeight(clause_id) == getSavedWeight(clause_id)) return;
         assert(getWeight(clause_id) < getSavedWeight(clause_id));
-        *((ULL *)&clauses[clause_id + 1]) = *((ULL *)&clauses[clause_id + 3]);
+        weight[clause_id] = savedWeight[clause_id];
         assert(getWeight(clause_id) > 0);
-        clauses[clause_id] &= ~DELETED;
+        header[clause_id] &= ~DELETED;
     }
     //! save the current weight of a clause.
     /*! \param clause_id The id of the clause.
      *  \remark saves a copy of the current weight
      */
     void saveWeight(int clause_id) {
-        assert(clause_id > 0 && clause_id < capacity &&
+        assert(isClause(clause_id) &&
                getLength(clause_id) > 0);
-        *((ULL *)&clauses[clause_id + 3]) = *((ULL *)&clauses[clause_id + 1]);
+        savedWeight[clause_id] = weight[clause_id];
     }
     //! increase the weight of a clause.
     /*! \param clause_id The id of the clause.
      *  \param w The weight to be added (w != 0).
      */
     void addWeight(int clause_id, ULL w, bool change_saved = false) {
-        assert(clause_id > 0 && clause_id < capacity && w != 0);
+        assert(isClause(clause_id) && w != 0);
         assert(!getSpecialFlag(clause_id));
         if (getWeight(clause_id) == 0) {
             assert(getDeleteFlag(clause_id) && w > 0);
             removeDeleteFlagFromClause(clause_id);
         }
         assert(w <= MAXWEIGHT - getWeight(clause_id));
-        *((ULL *)&clauses[clause_id + 1]) += w;
-        if (change_saved) *((ULL *)&clauses[clause_id + 3]) += w;
+        weight[clause_id] += w;
+        if (change_saved) savedWeight[clause_id] += w;
     }
     //! decrease the weight of a clause.
     /*! \param clause_id The id of the clause.
      *  \param w The weight to be subtracted (w != 0).
      */
     void subtractWeight(int clause_id, ULL w, bool change_saved = false) {
-        assert(clause_id > 0 && clause_id < capacity && w != 0 &&
+        assert(isClause(clause_id) && w != 0 &&
                !getDeleteFlag(clause_id));
         assert(!getSpecialFlag(clause_id));
-        *((ULL *)&clauses[clause_id + 1]) -= w;
+        weight[clause_id] -= w;
         if (change_saved) {
             assert(getSavedWeight(clause_id) >= w);
-            *((ULL *)&clauses[clause_id + 3]) -= w;
+            savedWeight[clause_id] -= w;
         }
         if (getWeight(clause_id) == 0) addDeleteFlag2Clause(clause_id);
     }
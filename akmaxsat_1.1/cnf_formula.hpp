@@ -22,33 +22,41 @@
 
 #include <cmath>
 #include <cstdio>
-#include <set>
 #include <utility>
 #include <vector>
 
 #include "clauses.hpp"
+#include "dimacs_parser.hpp"
+#include "literal_pair_index.hpp"
+#include "occurrence_lists.hpp"
 #include "restore_list.hpp"
+#include "solver_config.hpp"
+#include "solver_context.hpp"
+#include "wcnf_instance.hpp"
 using namespace std;
 
 //! The class CNF_Formula maintains the states of the CNF_Formula during
 //! backtracking
-template <class TL>
+/*! \tparam TL type of the literal weight sums
+ *  \tparam Config a SolverConfig selecting the optional parts of the solver
+ */
+template <class TL, class Config = DefaultConfig>
 class CNF_Formula {
     // private variables
     //! clause number to indicate a unit clause
     const static int UNIT_CLAUSE = 1;
-#ifdef FUIP
+    // used if Config::fuip is set
     vector<int> bla;
-    vector<int> *tadj;
+    OccurrenceLists tadj;
     int succ_cnt_fuip, total_cnt_fuip;
     int *Q2;
     char *visit2;
     int *ref_cnt;
-#endif
-#ifdef STATS
+    // used if Config::stats is set
     int *explored;
     long long *sum_cost;
-#endif
+    //! output sink and random number generator of this instance
+    SolverContext ctx;
     //! all clauses of the CNF formula
     Clauses all_clauses;
     //! boolean flag which indicates if the given formula has weighted clauses
@@ -57,9 +65,9 @@ class CNF_Formula {
     //! number of Variables in the formula
     int nVars;
     //! contains a list of pointers to clauses in which literal i occurs
-    vector<int> *appears;
+    OccurrenceLists appears;
     //! contains a list of clauses implying unit literal i
-    vector<int> *unit_implication_list;
+    OccurrenceLists unit_implication_list;
     //! contains the current size of each appears vector
     int *appears_len;
     //! contains the values assigned to the variables
@@ -70,6 +78,12 @@ class CNF_Formula {
     int n_assigned;
     //! stack of assigned literals
     int *assigned_literals;
+    //! the unassigned variables are free_vars[0 .. nVars - n_assigned); an
+    //! assigned variable is swapped behind them, where it stays until it is
+    //! unassigned since assignments are undone in reverse order
+    int *free_vars;
+    //! position of each unassigned variable in free_vars
+    int *free_pos;
     //! timestamp
     long long timestamp;
     //! timestamps when appears array was last traversed
@@ -89,15 +103,19 @@ class CNF_Formula {
     ULL *cost;
     //! best cost of a complete assignment
     ULL bestCost;
+    //! cost of the assignment stored in bestA, hard if there is none
+    ULL solutionCost;
+    //! lower bound on the cost of any complete assignment
+    ULL lowerBound;
     //! difference between current cost and bestCost
     ULL needed_for_skip;
     //! list of clauses which need to be reinserted
     restore_list rlist;
     //! stores data for each literal (depends on function)
     int *literal_data;
-    //! stores the clause id of clauses which contain the variables (a, b) at
-    //! position a * nVars + b
-    int *ternary_clause_data;
+    //! stores the clause id of ternary clauses which contain the literals
+    //! (a, b) with a < b besides the literal being resolved
+    LiteralPairIndex ternary_clause_data;
     //! stores the literals in the order in which they should be selected for
     //! propagation
     pair<TL, int> *literal_order;
@@ -136,19 +154,18 @@ class CNF_Formula {
     //! number of generalized unit propagations which produced a lower bound >=
     //! bestCost
     int succ_gup;
-#ifdef PROP_LIST
-    //! stack which contains literals which can be propagated
+    //! stack which contains literals which can be propagated (used if
+    //! Config::propList is set)
     int *propagation_stack;
     //! number of literals which can be propagated
     int propagation_stack_size;
     //! position of literal i on the propagation stack
     int *onstack;
-#endif
     //! list of clauses which were changed during lower bound calculation
     vector<int> changed;
     // height transform
     vector<double> psi;
-    vector<int> *ptr;
+    OccurrenceLists ptr;
 
     // private functions
     //! Normalize the clause array and determine if it is a tautology
@@ -175,16 +192,17 @@ class CNF_Formula {
         cout << "delete fulfilled" << endl;
 #endif
         assert(!assigned_values[abs(L)]);
-        vector<int> &appears2 = appears[L];
+        OccurrenceLists::List appears2 = appears[L];
         assert(appears_len[L] == (int)appears2.size());
-        for (int i = appears2.size() - 1; i >= 0; --i) {
-            int &it = appears2[i];
+        // the list is only shortened, so it can be walked by pointer
+        int *clauses = appears2.begin(), len = appears2.size();
+        for (int i = len - 1; i >= 0; --i) {
+            int &it = clauses[i];
             // remove clauses which already have a delete flag
             if (all_clauses.getDeleteFlag(it)) {
                 if (all_clauses.getSpecialFlag(it))
                     all_clauses.decreaseCounter(it);
-                it = appears2.back();
-                appears2.pop_back();
+                it = clauses[--len];
             } else {
                 // set the delete flag
                 all_clauses.addDeleteFlag2Clause(it);
@@ -235,7 +253,8 @@ class CNF_Formula {
                 }
             }
         }
-        appears_len[L] = (int)appears2.size();
+        appears2.resize(len);
+        appears_len[L] = len;
         // set new time stamp for the appears array
         appears_traversed[L] = timestamp++;
     }
@@ -277,15 +296,16 @@ class CNF_Formula {
         int l;
         assert((int)appears[L].size() == appears_len[L]);
         appears_traversed[L] = timestamp++;
-        vector<int> &appears2 = appears[L];
-        for (int i = appears2.size() - 1; i >= 0; --i) {
-            int &it = appears2[i];
+        OccurrenceLists::List appears2 = appears[L];
+        // the list is only shortened, so it can be walked by pointer
+        int *clauses = appears2.begin(), len = appears2.size();
+        for (int i = len - 1; i >= 0; --i) {
+            int &it = clauses[i];
             // remove clause with delete flags
             if (all_clauses.getDeleteFlag(it)) {
                 if (all_clauses.getSpecialFlag(it))
                     all_clauses.decreaseCounter(it);
-                it = appears2.back();
-                appears2.pop_back();
+                it = clauses[--len];
             } else {
                 // remove the literal from the clause
                 all_clauses.decreaseLength(it);
@@ -310,23 +330,22 @@ class CNF_Formula {
                     // unary resolution of literal, -literal may become possible
                     unary_resolution(literal);
                     assert(!assigned_values[abs(literal)]);
-#ifdef PROP_LIST
                     // check if literal can be propagated
-                    if (onstack[literal] < 0 &&
+                    if (Config::propList && onstack[literal] < 0 &&
                         W_unit[literal] + (TL)cost[n_assigned] >=
                             (TL)bestCost) {
                         onstack[literal] = propagation_stack_size;
                         propagation_stack[propagation_stack_size++] = literal;
                     }
-#endif
                     // set delete flag for unit clauses
                     all_clauses.addDeleteFlag2Clause(it);
                 }
             }
         }
-        appears_len[L] = (int)appears[L].size();
+        appears2.resize(len);
+        appears_len[L] = len;
 #ifndef NDEBUG
-        for (vector<int>::const_iterator it = appears[L].begin();
+        for (const int *it = appears[L].begin();
              it < appears[L].end(); ++it)
             assert(all_clauses.getDeleteFlag(*it) == false ||
                    all_clauses.getLength(*it) == 1);
@@ -342,16 +361,16 @@ class CNF_Formula {
         printf("propagating %d\n", L);
 #endif
         all_clauses.assignVariable(L);
-        vector<int> &appears2 = appears[L];
+        OccurrenceLists::List appears2 = appears[L];
 #ifndef NDEBUG
-        for (vector<int>::reverse_iterator it = appears2.rbegin();
+        for (reverse_iterator<int *> it = appears2.rbegin();
              it < appears2.rbegin() + ((int)appears2.size() - appears_len[L]);
              ++it)
             assert(all_clauses.getDeleteFlag(*it) == true);
 #endif
-        for (vector<int>::reverse_iterator it =
-                 appears2.rbegin() + ((int)appears2.size() - appears_len[L]);
-             it < appears2.rend(); ++it) {
+        reverse_iterator<int *> it =
+            appears2.rbegin() + ((int)appears2.size() - appears_len[L]);
+        for (reverse_iterator<int *> end = appears2.rend(); it < end; ++it) {
             if (all_clauses.getDeleteFlag(*it)) {
                 // in this case, it may be a clause to be deleted, or one which
                 // was used in an inconsistent subformula to increase the lower
@@ -388,24 +407,25 @@ class CNF_Formula {
     }
     //! add literal L back to clauses where it was removed
     inline void addLiteral(int L) {
-        vector<int> &appears2 = appears[L];
+        OccurrenceLists::List appears2 = appears[L];
         assert((int)appears2.size() == appears_len[L]);
-        for (vector<int>::reverse_iterator it = appears2.rbegin();
-             it < appears2.rend(); ++it) {
-            assert(all_clauses.getLength(*it) == 1 ||
-                   !all_clauses.getDeleteFlag(*it));
+        // positions are used since clauses may be pushed to other lists
+        for (int i = appears2.size() - 1; i >= 0; --i) {
+            int c = appears2[i];
+            assert(all_clauses.getLength(c) == 1 ||
+                   !all_clauses.getDeleteFlag(c));
             // check if clause was a unit clause
-            if (all_clauses.getLength(*it) == 1) {
-                int literal = *all_clauses.getLiterals(*it);
+            if (all_clauses.getLength(c) == 1) {
+                int literal = *all_clauses.getLiterals(c);
                 assert(literal != L);
                 // now we need to remove the delete flag
-                assert(all_clauses.getDeleteFlag(*it));
-                all_clauses.removeDeleteFlagFromClause(*it);
+                assert(all_clauses.getDeleteFlag(c));
+                all_clauses.removeDeleteFlagFromClause(c);
                 // adjust weights
-                W_binary[literal] += all_clauses.getWeight(*it);
-                W_binary[L] += all_clauses.getWeight(*it);
-                W_unit[literal] -= all_clauses.getWeight(*it);
-                W_unit_save[literal] -= all_clauses.getWeight(*it);
+                W_binary[literal] += all_clauses.getWeight(c);
+                W_binary[L] += all_clauses.getWeight(c);
+                W_unit[literal] -= all_clauses.getWeight(c);
+                W_unit_save[literal] -= all_clauses.getWeight(c);
 #ifdef PROP_LIST
 /*
                                 // the following lines remove a literal from the
@@ -428,14 +448,14 @@ class CNF_Formula {
                 // traversed after L was assigned false (which happened with
                 // time stamp appears_traversed[L]
                 if (appears_traversed[literal] > appears_traversed[L]) {
-                    appears[literal].push_back(*it);
+                    appears[literal].push_back(c);
                     ++appears_len[literal];
                 }
             }
             // update W_binary and W_large
-            else if (all_clauses.getLength(*it) == 2) {
-                const int_c *literals = all_clauses.getLiterals(*it);
-                ULL w = all_clauses.getWeight(*it);
+            else if (all_clauses.getLength(c) == 2) {
+                const int_c *literals = all_clauses.getLiterals(c);
+                ULL w = all_clauses.getWeight(c);
                 W_binary[literals[0]] -= w;
                 W_binary[literals[1]] -= w;
                 W_large[literals[0]] += w;
@@ -444,16 +464,16 @@ class CNF_Formula {
             }
             // increase the length of the clause (literal L will be added back
             // to the clause)
-            all_clauses.increaseLength(*it);
+            all_clauses.increaseLength(c);
         }
         // unassign literal L
         all_clauses.unassignVariable(L);
     }
     //! undo propagation of literal L
     inline void undoPropagateLiteral(int L) {
-        vector<int> &appears2 = appears[L];
-        for (vector<int>::const_iterator it = appears2.begin();
-             it < appears2.begin() + appears_len[L]; ++it) {
+        OccurrenceLists::List appears2 = appears[L];
+        for (const int *it = appears2.begin(), *end = it + appears_len[L];
+             it < end; ++it) {
             assert(!all_clauses.getDeleteFlag(*it));
             all_clauses.increaseLength(*it);
         }
@@ -462,22 +482,18 @@ class CNF_Formula {
 
     //! add literal L to clauses where it was removed if there is a conflict
     inline int addLiteralConflict(int L) {
-        vector<int> &appears2 = appears[L];
+        OccurrenceLists::List appears2 = appears[L];
         // count how many clauses in the inconsistent subformula depend on
         // propagating L
         int propagated = 0;
-#ifdef FUIP
-        bla.clear();
-#endif
-        for (vector<int>::const_iterator it = appears2.begin();
-             it < appears2.begin() + appears_len[L]; ++it) {
+        if (Config::fuip) bla.clear();
+        for (const int *it = appears2.begin(), *end = it + appears_len[L];
+             it < end; ++it) {
             assert(!all_clauses.getDeleteFlag(*it));
             // if clause has a marker flag, it belongs to inconsistent
             // subformula
             if (all_clauses.getMarker(*it)) {
-#ifdef FUIP
-                bla.push_back(*it);
-#endif
+                if (Config::fuip) bla.push_back(*it);
                 ++propagated;
             }
             all_clauses.increaseLength(*it);
@@ -492,19 +508,19 @@ class CNF_Formula {
     inline TL binary_ternary_resolution(int L) {
         int_c nC[2];
         TL cnt = 0;
-        int other1, other2, id;
+        int other1, other2;
         const int_c *literals;
         // store in literal_data[i] the clause consisting of literals L and i
-        // store in ternary_clause_data[(L1+nVars)*(2*nVars+1)+L2+nVars] the
-        // clause consisting of literals L, L1 and L2
-        for (int i = appears[L].size() - 1; i >= 0; --i) {
-            int &it = appears[L][i];
+        // store in ternary_clause_data(L1, L2) the clause consisting of
+        // literals L, L1 and L2
+        int *clauses = appears[L].begin(), len = appears[L].size();
+        for (int i = len - 1; i >= 0; --i) {
+            int &it = clauses[i];
             if (all_clauses.getDeleteFlag(it)) {
                 // remove clause pointers which should be deleted
                 if (all_clauses.getSpecialFlag(it))
                     all_clauses.decreaseCounter(it);
-                it = appears[L].back();
-                appears[L].pop_back();
+                it = clauses[--len];
             } else {
                 assert(all_clauses.getWeight(it) > 0);
                 assert(!all_clauses.getSpecialFlag(it));
@@ -526,8 +542,7 @@ class CNF_Formula {
                         assert(all_clauses.getWeight(it) > 0);
                         literal_data[other1] = it;
                     }
-                } else if (ternary_clause_data != NULL &&
-                           all_clauses.getLength(it) == 3) {
+                } else if (all_clauses.getLength(it) == 3) {
                     literals = all_clauses.getLiterals(it);
                     other1 = other2 = 0;
                     // determine the other two literals other1 and other2 which
@@ -540,37 +555,35 @@ class CNF_Formula {
                                 other2 = literals[i];
                         }
                     if (other1 > other2) swap(other1, other2);
-                    // calculate a unique id for a clause containing literal L
-                    // and literal other1 and literal other2
-                    id = (other1 + nVars) * (nVars * 2 + 1) + other2 + nVars;
+                    int &id = ternary_clause_data(other1, other2);
                     // check if we can merge the clause
-                    if (ternary_clause_data[id] > 0) {
-                        assert(ternary_clause_data[id] != it);
+                    if (id > 0) {
+                        assert(id != it);
                         ULL w = all_clauses.getWeight(it);
-                        assert(all_clauses.getWeight(ternary_clause_data[id]) >
-                               0);
-                        all_clauses.addWeight(ternary_clause_data[id], w);
+                        assert(all_clauses.getWeight(id) > 0);
+                        all_clauses.addWeight(id, w);
                         all_clauses.subtractWeight(it, w, true);
                         rlist.addEntry(it);
                         rlist.commit(timestamp++, w, false);
                     } else {
                         assert(all_clauses.getWeight(it) > 0);
-                        ternary_clause_data[id] = it;
+                        id = it;
                     }
                 }
             }
         }
+        appears[L].resize(len);
         // now do the resolution using literal_data and ternary_clause_data
-        // arrays
+        // positions are used since clauses may be pushed to other lists
         for (int i = appears[L].size() - 1; i >= 0; --i) {
-            int &it = appears[L][i];
+            int it = appears[L][i];
             assert(!all_clauses.getSpecialFlag(it));
             if (all_clauses.getDeleteFlag(it)) {
                 // in this case it can only be a clause which was deleted
                 // because it is the same as another clause, and its weight was
                 // added to the other clause we only need to delete the clause
                 // pointer
-                it = appears[L].back();
+                appears[L][i] = appears[L].back();
                 appears[L].pop_back();
             } else {
                 if (all_clauses.getLength(it) == 2) {
@@ -621,13 +634,12 @@ class CNF_Formula {
                         if (w == wmin) {
                             // if the complete weight of the clause was
                             // subtracted, the clause pointer can be deleted
-                            it = appears[L].back();
+                            appears[L][i] = appears[L].back();
                             appears[L].pop_back();
                             continue;
                         }
                     }
-                } else if (ternary_clause_data != NULL &&
-                           all_clauses.getLength(it) == 3) {
+                } else if (all_clauses.getLength(it) == 3) {
                     literals = all_clauses.getLiterals(it);
                     other1 = other2 = 0;
                     // determine the other two literals other1 and other2 which
@@ -640,10 +652,10 @@ class CNF_Formula {
                                 other2 = literals[i];
                         }
                     if (other1 > other2) swap(other1, other2);
-                    id = (other1 + nVars) * (nVars * 2 + 1) + other2 + nVars;
-                    if (ternary_clause_data[id] <= 0) continue;
-                    assert(ternary_clause_data[id] == it);
-                    ternary_clause_data[id] = 0;
+                    int *id = ternary_clause_data.find(other1, other2);
+                    if (id == NULL || *id <= 0) continue;
+                    assert(*id == it);
+                    *id = 0;
                     ULL w = all_clauses.getWeight(it);
                     // check if we changed the weight
                     if (all_clauses.getSavedWeight(it) != w) {
@@ -656,11 +668,11 @@ class CNF_Formula {
                     // first negate other1
                     int other3 = -other1, other4 = other2;
                     if (other3 > other4) swap(other3, other4);
-                    id = (other3 + nVars) * (nVars * 2 + 1) + other4 + nVars;
+                    id = ternary_clause_data.find(other3, other4);
                     // check if there exists a clause (L, -other1, other2)
                     // -> resolution with (L, other1, other2) possible
-                    if (ternary_clause_data[id] > 0) {
-                        int c = ternary_clause_data[id];
+                    if (id != NULL && *id > 0) {
+                        int c = *id;
                         ULL w2 = all_clauses.getWeight(c);
                         if (all_clauses.getSavedWeight(c) != w2) {
                             assert(all_clauses.getSavedWeight(c) < w2);
@@ -672,7 +684,7 @@ class CNF_Formula {
                         }
                         ULL wmin = min(w, w2);
                         assert(wmin > 0);
-                        if (wmin == w2) ternary_clause_data[id] = 0;
+                        if (wmin == w2) *id = 0;
                         all_clauses.subtractWeight(c, wmin, true);
                         all_clauses.subtractWeight(it, wmin, true);
                         rlist.addEntry(c);
@@ -704,7 +716,7 @@ class CNF_Formula {
                         // if clause weight has become zero, the clause pointer
                         // can be deleted
                         if (w == wmin) {
-                            it = appears[L].back();
+                            appears[L][i] = appears[L].back();
                             appears[L].pop_back();
                             continue;
                         }
@@ -714,11 +726,11 @@ class CNF_Formula {
                     other3 = other1;
                     other4 = -other2;
                     if (other3 > other4) swap(other3, other4);
-                    id = (other3 + nVars) * (nVars * 2 + 1) + other4 + nVars;
+                    id = ternary_clause_data.find(other3, other4);
                     // check if there exists a clause (L, other1, -other2)
                     // -> resolution with (L, other1, other2) possible
-                    if (ternary_clause_data[id] > 0) {
-                        int c = ternary_clause_data[id];
+                    if (id != NULL && *id > 0) {
+                        int c = *id;
                         ULL w2 = all_clauses.getWeight(c);
                         if (all_clauses.getSavedWeight(c) != w2) {
                             assert(all_clauses.getSavedWeight(c) < w2);
@@ -730,7 +742,7 @@ class CNF_Formula {
                         }
                         ULL wmin = min(w, w2);
                         assert(wmin > 0);
-                        if (wmin == w2) ternary_clause_data[id] = 0;
+                        if (wmin == w2) *id = 0;
                         all_clauses.subtractWeight(c, wmin, true);
                         all_clauses.subtractWeight(it, wmin, true);
                         // adjust weights
@@ -762,7 +774,7 @@ class CNF_Formula {
                         // if weight of the clause has become zero, the clause
                         // pointer can be deleted
                         if (w == wmin) {
-                            it = appears[L].back();
+                            appears[L][i] = appears[L].back();
                             appears[L].pop_back();
                             continue;
                         }
@@ -773,15 +785,15 @@ class CNF_Formula {
         // take_back contains the binary clauses created by resolution of
         // ternary clauses
         if (!take_back.empty()) {
-            appears[L].insert(appears[L].end(), take_back.begin(),
-                              take_back.end());
+            appears[L].append(take_back.begin(), take_back.end());
             take_back.clear();
         }
+        ternary_clause_data.clear();
         appears_len[L] = (int)appears[L].size();
         appears_traversed[L] = timestamp++;
 #ifndef NDEBUG
-        for (vector<int>::const_iterator it = appears[L].begin();
-             it != appears[L].end(); ++it)
+        for (const int *it = appears[L].begin(), *end = appears[L].end();
+             it != end; ++it)
             assert(all_clauses.getDeleteFlag(*it) == false);
 #endif
         assert(!assigned_values[abs(L)]);
@@ -1137,13 +1149,11 @@ class CNF_Formula {
             saveSubtraction(needed_for_skip, minweight);
             minweight = 0;
             unary_resolution(other);
-#ifdef PROP_LIST
-            if (onstack[-other] < 0 &&
+            if (Config::propList && onstack[-other] < 0 &&
                 W_unit[-other] + (TL)cost[n_assigned] >= (TL)bestCost) {
                 onstack[-other] = propagation_stack_size;
                 propagation_stack[propagation_stack_size++] = -other;
             }
-#endif
         }
         /*
         // the following lines can be used to do Max-SAT resolution yielding an
@@ -1412,9 +1422,9 @@ true);
                     for (int i = all_clauses.getLength(clause_id) - 1; i >= 0;
                          --i) {
                         int cnt = 0;
-                        for (vector<int>::const_iterator it =
-                                 appears[literals[i]].begin();
-                             it != appears[literals[i]].end(); ++it)
+                        for (const int *it = appears[literals[i]].begin(),
+                                       *end = appears[literals[i]].end();
+                             it != end; ++it)
                             if (*it == clause_id) ++cnt;
                         assert(cnt == 1);
                     }
@@ -1424,9 +1434,9 @@ true);
                              j >= 0; --j)
                             if (literals[j] == i) valid = false;
                         if (!valid) continue;
-                        for (vector<int>::const_iterator it =
-                                 appears[i].begin();
-                             it != appears[i].end(); ++it)
+                        for (const int *it = appears[i].begin(),
+                                       *end = appears[i].end();
+                             it != end; ++it)
                             assert(*it != clause_id);
                     }
 #endif
@@ -1447,9 +1457,9 @@ true);
                 for (int i = 0; i < l; ++i) {
 #ifndef NDEBUG
                     bool found = false;
-                    for (vector<int>::const_iterator it =
-                             appears[literals[i]].begin();
-                         it != appears[literals[i]].end(); ++it)
+                    for (const int *it = appears[literals[i]].begin(),
+                                   *end = appears[literals[i]].end();
+                         it != end; ++it)
                         if (*it == clause_id) {
                             found = true;
                             break;
@@ -1515,14 +1525,12 @@ true);
                    !assigned_values[abs(l1)]);
             W_unit[l1] += minweight;
             W_unit_save[l1] += minweight;
-#ifdef PROP_LIST
             // check if the literal l1 can be propagated
-            if (onstack[l1] < 0 &&
+            if (Config::propList && onstack[l1] < 0 &&
                 W_unit[l1] + (TL)cost[n_assigned] >= (TL)bestCost) {
                 onstack[l1] = propagation_stack_size;
                 propagation_stack[propagation_stack_size++] = l1;
             }
-#endif
             rlist.addEntry(l1 - nVars);
             // add compensation clauses (-l1, l2, l3) and (l1, -l2, -l3)
             // also update the weights according to the new clauses
@@ -1565,11 +1573,11 @@ true);
     void do_sort(int i) {
         vector<pair<ULL, int> > temp;
         temp.reserve(appears[i].size());
-        for (vector<int>::const_iterator it = appears[i].begin();
-             it != appears[i].end(); ++it)
+        for (const int *it = appears[i].begin(), *end = appears[i].end();
+             it != end; ++it)
             temp.push_back(make_pair(all_clauses.getWeight(*it), *it));
         sort(temp.begin(), temp.end());
-        vector<int>::iterator it2 = appears[i].begin();
+        int *it2 = appears[i].begin();
         for (vector<pair<ULL, int> >::iterator it = temp.begin();
              it != temp.end(); ++it)
             *it2++ = it->second;
@@ -1652,11 +1660,9 @@ true);
                     break;
                 }
             }
-            // uncomment the following two lines if only unit propagation and
-            // failed literal detection should be used
-#ifdef NO_GUP
-            if (!found && fl) break;
-#endif
+            // only unit propagation and failed literal detection are used
+            // without generalized unit propagation
+            if (!Config::useGup && !found && fl) break;
             if (!found) {
                 int save_head = head;
                 int save_vars_top = vars_top;
@@ -1864,9 +1870,9 @@ true);
                     if (pos < 3) pos = -1;
                     assert(!unit_implication_list[-*it].empty());
                     which.push_back(-*it);
-                    for (vector<int>::const_iterator it2 =
-                             unit_implication_list[-*it].begin();
-                         it2 != unit_implication_list[-*it].end(); ++it2) {
+                    for (const int *it2 = unit_implication_list[-*it].begin(),
+                                   *end = unit_implication_list[-*it].end();
+                         it2 != end; ++it2) {
                         assert(*it2 > UNIT_CLAUSE &&
                                !all_clauses.getDeleteFlag(*it2));
                         if (!all_clauses.getMarker(*it2)) {
@@ -2104,10 +2110,8 @@ true);
         all_clauses.addMarker2Clause(which.back());
         int t, var = 0, pos = 0;
         vector<int> vars2;
-#ifdef FUIP
         int pos2 = 0;
-        ref_cnt[0] = 0;
-#endif
+        if (Config::fuip) ref_cnt[0] = 0;
         // process propagation stack in reverse order
         for (int *it = vars + vars_top; it > vars + save_vars_top; --it) {
 #ifdef DEBUG
@@ -2121,18 +2125,19 @@ true);
                     pos = which.size();
                     var = *it;
                 }
-#ifdef FUIP
-                vars2.push_back(*it);
-                int cur = which.size();
-                ref_cnt[cur] = 0;
-                for (vector<int>::const_iterator it2 = bla.begin();
-                     it2 != bla.end(); ++it2) {
-                    int t = distance(which.begin(),
+                if (Config::fuip) {
+                    vars2.push_back(*it);
+                    int cur = which.size();
+                    ref_cnt[cur] = 0;
+                    for (vector<int>::const_iterator it2 = bla.begin();
+                         it2 != bla.end(); ++it2) {
+                        int t =
+                            distance(which.begin(),
                                      find(which.begin(), which.end(), *it2));
-                    tadj[cur].push_back(t);
-                    ++ref_cnt[t];
+                        tadj[cur].push_back(t);
+                        ++ref_cnt[t];
+                    }
                 }
-#endif
                 which.push_back(literal_data[*it]);
                 assert(it == vars + save_vars_top + 1 ||
                        literal_data[*it] != UNIT_CLAUSE);
@@ -2144,37 +2149,36 @@ true);
             }
             literal_data[*it] = 0;
         }
-#ifdef FUIP
-        int l2 = 0;
-        for (int i = 0; i < (int)which.size(); ++i) {
-            if (ref_cnt[i] == 0) Q2[l2++] = i;
-            visit2[i] = 0;
-        }
-        int work_cnt = 0;
-        for (int i = 0; i < l2; ++i) {
-            int cur = Q2[i];
-            if (l2 - i == 1 && !work_cnt && cur) pos2 = cur;
-            for (vector<int>::const_iterator it = tadj[cur].begin();
-                 it != tadj[cur].end(); ++it) {
-                if (!visit2[*it]) {
-                    ++work_cnt;
-                    visit2[*it] = 1;
-                }
-                if (--ref_cnt[*it] == 0) {
-                    Q2[l2++] = *it;
-                    --work_cnt;
+        if (Config::fuip) {
+            int l2 = 0;
+            for (int i = 0; i < (int)which.size(); ++i) {
+                if (ref_cnt[i] == 0) Q2[l2++] = i;
+                visit2[i] = 0;
+            }
+            int work_cnt = 0;
+            for (int i = 0; i < l2; ++i) {
+                int cur = Q2[i];
+                if (l2 - i == 1 && !work_cnt && cur) pos2 = cur;
+                for (const int *it = tadj[cur].begin(), *end = tadj[cur].end();
+                     it != end; ++it) {
+                    if (!visit2[*it]) {
+                        ++work_cnt;
+                        visit2[*it] = 1;
+                    }
+                    if (--ref_cnt[*it] == 0) {
+                        Q2[l2++] = *it;
+                        --work_cnt;
+                    }
                 }
+                tadj[cur].clear();
+            }
+            if (pos < (int)which.size() - 1) ++total_cnt_fuip;
+            if (pos < pos2)
+                ctx.print("error: here with pos = %d, pos2 = %d\n", pos, pos2);
+            else if (pos > pos2) {
+                ++succ_cnt_fuip;
             }
-            tadj[cur].clear();
-        }
-        if (pos < (int)which.size() - 1) ++total_cnt_fuip;
-        if (pos < pos2)
-            fprintf(stderr, "error: here with pos = %d, pos2 = %d\n", pos,
-                    pos2);
-        else if (pos > pos2) {
-            ++succ_cnt_fuip;
         }
-#endif
         // no FUIP - uncomment next line
 #ifdef NO_FUIP
         pos = which.size() - 1;
@@ -2191,7 +2195,7 @@ true);
             all_clauses.removeMarkerFromClause(*it);
         }
         which.resize(pos);
-        unit_implication_list[var] = which;
+        unit_implication_list[var].assign(which.begin(), which.end());
         which.clear();
         return var;
     }
@@ -2217,32 +2221,9 @@ true);
         if (wa > difference) return wa - potential - difference;
         return -potential;
     }
-    //! generalized unit propagation to find inconsistent subformulas
-    void generalized_unit_propagation() {
-        l = 0;
-        for (int i = 1; i <= nVars; ++i) {
-            if (!assigned_values[i]) {
-                literal_order[l].second = i;
-                literal_order[l].first =
-                    (W_binary[i] + W_large[i]) * (W_binary[-i] + W_large[-i]);
-                ++l;
-            }
-        }
-        sort(literal_order, literal_order + l);
-        bool fl;
-        int iv = l - 1, iv2 = l / 2;
-        while (needed_for_skip > 0) {
-            if (!detectConflictFl(fl, iv, iv2)) break;
-            // check if failed literals were used; if not, transformation rules
-            // can possibly be applied
-            fl ? resolveConflictFl() : resolveConflict();
-        }
-        ++total_gup;
-        if (!needed_for_skip) {
-            ++succ_gup;
-            return;
-        }
-#ifdef CALC_MH
+    //! increase the lower bound with the height transformation of the
+    //! remaining formula
+    void height_transformation() {
         reverse(literal_order, literal_order + l);
         psi.clear();
         for (int ii = 0; ii < l; ++ii) {
@@ -2272,8 +2253,8 @@ true);
                 psi.push_back(0);
                 psi.push_back(0);
             }
-            for (vector<int>::iterator it = appears[i].begin();
-                 it != appears[i].end(); ++it) {
+            for (int *it = appears[i].begin(), *end = appears[i].end();
+                 it != end; ++it) {
                 if (all_clauses.getDeleteFlag(*it)) continue;
                 ++c;
                 const int_c *literals = all_clauses.getLiterals(*it);
@@ -2290,8 +2271,8 @@ true);
                     psi.push_back(0);
                 }
             }
-            for (vector<int>::iterator it = appears[-i].begin();
-                 it != appears[-i].end(); ++it) {
+            for (int *it = appears[-i].begin(), *end = appears[-i].end();
+                 it != end; ++it) {
                 if (all_clauses.getDeleteFlag(*it)) continue;
                 ++c;
                 const int_c *literals = all_clauses.getLiterals(*it);
@@ -2310,20 +2291,22 @@ true);
             }
         }
         if ((c + c2) * 2 != (int)psi.size())
-            printf("%d %d\n", (c + c2) * 2, (int)psi.size());
+            ctx.print("%d %d\n", (c + c2) * 2, (int)psi.size());
         bool stop = false;
         vector<double> old;
         int iter = 0;
         double maxdiff;
-        while (!stop && (iter++ < 100 || (!n_assigned && iter++ < 1000))) {
+        bool balanced = true;
+        while (balanced && !stop &&
+               (iter++ < 100 || (!n_assigned && iter++ < 1000))) {
             stop = true;
             maxdiff = 1e-6;
             for (int ii = 0; ii < l; ++ii) {
                 int i = literal_order[ii].second;
                 double m1 = 0, m2 = 0;
                 old.clear();
-                for (vector<int>::iterator it = ptr[i].begin();
-                     it != ptr[i].end(); ++it) {
+                for (int *it = ptr[i].begin(), *end = ptr[i].end();
+                     it != end; ++it) {
                     int isneg = (*it & 1);
                     int p = *it++ - isneg;
                     old.push_back(psi[p]);
@@ -2342,8 +2325,8 @@ true);
                 m2 /= (ptr[i].size() / 2);
                 vector<double>::iterator it2 = old.begin();
                 double sum1 = 0, sum2 = 0;
-                for (vector<int>::iterator it = ptr[i].begin();
-                     it != ptr[i].end(); ++it) {
+                for (int *it = ptr[i].begin(), *end = ptr[i].end();
+                     it != end; ++it) {
                     int isneg = (*it & 1);
                     int p = *it++ - isneg;
                     if (isneg) {
@@ -2369,11 +2352,16 @@ true);
                     ++it2;
                 }
                 if (fabs(sum1) > 1e-7 || fabs(sum2) > 1e-7) {
-                    printf("%lf %lf\n", sum1, sum2);
-                    exit(1);
+                    ctx.print("%lf %lf\n", sum1, sum2);
+                    assert(fabs(sum1) <= 1e-7 && fabs(sum2) <= 1e-7);
+                    balanced = false;
+                    break;
                 }
             }
         }
+        // the bound of unbalanced heights may exceed the optimum, so that the
+        // node falls back to the weaker bound of the inconsistent subformulas
+        if (!balanced) return;
         double lb = 0;
         for (int i = 0; i < (int)psi.size();) {
             lb += psi[i] - clause_height(i, -1, 0);
@@ -2386,62 +2374,94 @@ true);
             return;
         }
         if (n_assigned == 0)
-            printf("%lf iter=%d maxdiff=%lf\n", lb, iter, maxdiff);
+            ctx.print("%lf iter=%d maxdiff=%lf\n", lb, iter, maxdiff);
         needed_for_skip -= (long long)lb;
-#endif
+    }
+    //! order the unassigned variables by their weights in literal_order
+    /*! free_vars keeps the order of the previous call, in which only few
+     * variables are usually out of place; insertion sort repairs it in
+     * linear time then and falls back to sort when many entries move
+     */
+    void orderLiterals() {
+        for (l = 0; l < nVars - n_assigned; ++l) {
+            int i = free_vars[l];
+            literal_order[l].second = i;
+            literal_order[l].first =
+                (W_binary[i] + W_large[i]) * (W_binary[-i] + W_large[-i]);
+        }
+        long long moves = 4LL * l + 64;
+        for (int k = 1; k < l; ++k) {
+            pair<TL, int> x = literal_order[k];
+            int j = k;
+            for (; j > 0 && x < literal_order[j - 1]; --j)
+                literal_order[j] = literal_order[j - 1];
+            literal_order[j] = x;
+            if ((moves -= k - j) < 0) {
+                sort(literal_order, literal_order + l);
+                break;
+            }
+        }
+        // remember the order for the next call
+        for (int k = 0; k < l; ++k) {
+            free_vars[k] = literal_order[k].second;
+            free_pos[free_vars[k]] = k;
+        }
+    }
+    //! generalized unit propagation to find inconsistent subformulas
+    void generalized_unit_propagation() {
+        orderLiterals();
+        bool fl;
+        int iv = l - 1, iv2 = l / 2;
+        while (needed_for_skip > 0) {
+            if (!detectConflictFl(fl, iv, iv2)) break;
+            // check if failed literals were used; if not, transformation rules
+            // can possibly be applied
+            fl ? resolveConflictFl() : resolveConflict();
+        }
+        ++total_gup;
+        if (!needed_for_skip) {
+            ++succ_gup;
+            return;
+        }
+        if (Config::calcMh) height_transformation();
 #ifndef NDEBUG
         for (int i = 1; i <= nVars; ++i)
             assert(literal_data[i] == 0 && literal_data[-i] == 0);
 #endif
     }
 
-    // public functions
-   public:
-    //! CNF_Formula constructor
-    /*! \param istr the input stream from which the formula can be read
-     */
-    CNF_Formula(istream &istr) {
+    //! build the formula data structures from the clauses of inst
+    void initialize(const WcnfInstance &inst) {
         total_gup = succ_gup = 0;
-        string line;
-        int nClauses, t = 0;
-        char type[100];
-        // parse the input file
-        while (getline(istr, line)) {
-            // look for the parameter line
-            if (line[0] == 'p' && line[1] == ' ') {
-                t = sscanf(line.c_str(), "p %s %d %d %llu", type, &maxVn,
-                           &nClauses, &hard);
-                if (t >= 3) break;
-            }
-        }
-        if (t < 3)
-            fprintf(stderr, "Parse error: did not find the parameter line\n");
-        assert(t >= 3);
-        if (t == 3 || !hard) hard = MAXWEIGHT;
-        // check if the formula contains weighted clauses or not
-        if (!strcmp(type, "wcnf"))
-            isWcnf = true;
-        else {
-            assert(!strcmp(type, "cnf"));
-            isWcnf = false;
-        }
+        maxVn = inst.maxVn;
+        hard = inst.hard ? inst.hard : MAXWEIGHT;
+        isWcnf = inst.weighted;
+        int nClauses = inst.nClauses();
         vector<int> lengths, literals;
         vector<ULL> weights;
+        lengths.reserve(nClauses);
+        weights.reserve(nClauses);
+        literals.reserve(inst.literals.size());
         maps_to = new int[maxVn + 1];
         memset(maps_to, -1, sizeof(int) * (maxVn + 1));
         nVars = 0;
-        int var;
-        // read the clauses and construct the formula data structures
-        for (int i = 0; i < nClauses; ++i) {
-            vector<int> clause;
-            ULL weight = 1;
-            if (isWcnf) {
-                // read the weight
-                istr >> weight;
-                assert(weight > 0 && weight <= MAXWEIGHT);
+        ULL constant = 0;
+        vector<int_c> clause;
+        vector<int_c>::const_iterator lit = inst.literals.begin();
+        // construct the clause arrays in the compacted variable numbering
+        for (int i = 0; i < inst.nClauses(); ++i) {
+            clause.assign(lit, lit + inst.lengths[i]);
+            lit += inst.lengths[i];
+            // a clause weighs at most the hard weight, so that sums of hard
+            // weights do not overflow
+            ULL weight = min(inst.weights[i], hard);
+            assert(weight > 0);
+            if (clause.empty()) {
+                // clauses without literals are always violated
+                constant += min(weight, MAXWEIGHT - constant);
+                --nClauses;
+                continue;
             }
-            // read the literals in the clause
-            while (istr >> var && var) clause.push_back(var);
             // now remove duplicate literals, and check if the clause is a
             // tautology
             if (normalize_clause_array(clause)) {
@@ -2469,49 +2489,52 @@ true);
                 weights.push_back(weight);
             }
             // in this case the clause is a tautology and can be ignored
-            else {
-                --i;
+            else
                 --nClauses;
-            }
         }
         if (nVars != maxVn)
-            printf(
+            ctx.print(
                 "c Number of variables occuring in the formula: %d max "
                 "variable = %d -> remapping\n",
                 nVars, maxVn);
         // store in mapping the original variable number of each new variable
         mapping = new int[nVars + 1];
-#ifdef STATS
-        explored = new int[nVars + 1];
-        sum_cost = new long long[nVars + 1];
-        memset(explored, 0, sizeof(int) * (nVars + 1));
-        memset(sum_cost, 0, sizeof(long long) * (nVars + 1));
-#endif
+        explored = NULL;
+        sum_cost = NULL;
+        if (Config::stats) {
+            explored = new int[nVars + 1];
+            sum_cost = new long long[nVars + 1];
+            memset(explored, 0, sizeof(int) * (nVars + 1));
+            memset(sum_cost, 0, sizeof(long long) * (nVars + 1));
+        }
         for (int i = 1; i <= maxVn; ++i) {
             if (maps_to[i] < 0) continue;
             assert(maps_to[i] > 0 && maps_to[i] <= nVars);
             mapping[maps_to[i]] = i;
         }
         vars_top = -1;
-#ifdef FUIP
-        tadj = new vector<int>[2 * nVars];
         succ_cnt_fuip = total_cnt_fuip = 0;
-        ref_cnt = new int[2 * nVars];
-        Q2 = new int[2 * nVars];
-        visit2 = new char[2 * nVars];
-#endif
-        ptr = new vector<int>[2 * nVars + 1];
+        ref_cnt = Q2 = NULL;
+        visit2 = NULL;
+        if (Config::fuip) {
+            tadj.init(0, 2 * nVars - 1);
+            ref_cnt = new int[2 * nVars];
+            Q2 = new int[2 * nVars];
+            visit2 = new char[2 * nVars];
+        }
+        if (Config::calcMh) ptr.init(0, nVars);
         vars = new int[2 * nVars];
         Q = new int[2 * nVars];
         cost = new ULL[nVars + 1];
-        cost[0] = 0;
-#ifdef PROP_LIST
-        propagation_stack = new int[nVars * 2];
+        cost[0] = constant;
+        propagation_stack = onstack = NULL;
         propagation_stack_size = 0;
-        onstack = new int[nVars * 2 + 1];
-        memset(onstack, -1, sizeof(int) * (2 * nVars + 1));
-        onstack += nVars;
-#endif
+        if (Config::propList) {
+            propagation_stack = new int[nVars * 2];
+            onstack = new int[nVars * 2 + 1];
+            memset(onstack, -1, sizeof(int) * (2 * nVars + 1));
+            onstack += nVars;
+        }
         W_unit = new TL[2 * nVars + 1];
         W_binary = new TL[2 * nVars + 1];
         W_large = new TL[2 * nVars + 1];
@@ -2522,25 +2545,26 @@ true);
         memset(W_large, 0, sizeof(TL) * (2 * nVars + 1));
         memset(W_unit_save, 0, sizeof(TL) * (2 * nVars + 1));
         literal_data = new int[2 * nVars + 1];
-        ternary_clause_data =
-            (nVars > 5000 ? NULL : new int[(2 * nVars + 1) * (2 * nVars + 1)]);
         literal_order = new pair<TL, int>[2 * nVars];
         memset(literal_data, 0, sizeof(int) * (2 * nVars + 1));
-        appears = new vector<int>[2 * nVars + 1];
-        unit_implication_list = new vector<int>[2 * nVars + 1];
+        appears.init(-nVars, nVars);
+        unit_implication_list.init(-nVars, nVars);
         appears_len = new int[2 * nVars + 1];
         memset(appears_len, 0, sizeof(int) * (2 * nVars + 1));
         appears_len += nVars;
         appears_traversed = new long long[2 * nVars + 1];
         memset(appears_traversed, -1, sizeof(long long) * (2 * nVars + 1));
-        if (ternary_clause_data != NULL)
-            memset(ternary_clause_data, 0,
-                   sizeof(int) * (2 * nVars + 1) * (2 * nVars + 1));
         assigned_values = new char[nVars + 1];
         bestA = new char[nVars + 1];
         memset(assigned_values, 0, sizeof(char) * (nVars + 1));
         memset(bestA, 0, sizeof(char) * (nVars + 1));
         assigned_literals = new int[nVars + 1];
+        free_vars = new int[nVars];
+        free_pos = new int[nVars + 1];
+        for (int i = 1; i <= nVars; ++i) {
+            free_vars[i - 1] = i;
+            free_pos[i] = i - 1;
+        }
         // since we want to index with values in the range [-nVars, nVars], add
         // +nVars to the pointers
         W_unit += nVars;
@@ -2548,8 +2572,6 @@ true);
         W_large += nVars;
         W_unit_save += nVars;
         W_lb += nVars;
-        appears += nVars;
-        unit_implication_list += nVars;
         appears_traversed += nVars;
         literal_data += nVars;
         n_assigned = 0;
@@ -2558,14 +2580,26 @@ true);
         assert(nClauses == (int)weights.size());
         // initialize additional variables of the clauses data structure
         all_clauses.init(nVars);
+        all_clauses.reserve(nClauses);
+        // lay out the appears lists contiguously in the order of the literals
+        vector<int> occurrences(2 * nVars + 1, 0);
         vector<int_c>::iterator it = literals.begin();
+        for (int i = 0; i < nClauses; ++i) {
+            if (lengths[i] > 1)
+                for (int j = 0; j < lengths[i]; ++j)
+                    ++occurrences[it[j] + nVars];
+            it += lengths[i];
+        }
+        for (int i = -nVars; i <= nVars; ++i)
+            appears.reserve(i, occurrences[i + nVars]);
+        it = literals.begin();
         // construct the formula data structures
         for (int i = 0; i < nClauses; ++i) {
             ULL weight = weights[i];
             int len = lengths[i];
             if (len == 1) {
-                W_unit[*it] += weight;
-                W_unit_save[*it] += weight;
+                W_unit[*it] = (TL)min((ULL)W_unit[*it] + weight, hard);
+                W_unit_save[*it] = W_unit[*it];
                 ++it;
                 continue;
             }
@@ -2589,13 +2623,58 @@ true);
             }
             delete[] clause_array;
         }
-        bestCost = hard;
+        bestCost = solutionCost = hard;
+        lowerBound = 0;
+        // without variables the empty assignment is complete
+        if (nVars == 0) bestCost = solutionCost = min(constant, hard);
         assert(it >= literals.end());
         for (int i = 1; i <= nVars; ++i) {
             do_sort(i);
             do_sort(-i);
         }
     }
+
+    // public functions
+   public:
+    //! CNF_Formula constructor
+    /*! \param istr the input stream from which the formula can be read
+     */
+    /*! \param ctx output sink and random number generator of the instance
+     */
+    CNF_Formula(istream &istr, const SolverContext &ctx = SolverContext())
+        : ctx(ctx) {
+        WcnfInstance inst;
+        bool parsed = readDimacs(istr, inst);
+        assert(parsed);
+        (void)parsed;
+        initialize(inst);
+    }
+    //! CNF_Formula constructor
+    /*! \param filename the name of a file from which the formula can be
+     *  read; it is mapped into memory
+     */
+    /*! \param ctx output sink and random number generator of the instance
+     */
+    CNF_Formula(const char *filename,
+                const SolverContext &ctx = SolverContext())
+        : ctx(ctx) {
+        WcnfInstance inst;
+        bool parsed = readDimacsFile(filename, inst);
+        assert(parsed);
+        (void)parsed;
+        initialize(inst);
+    }
+    //! CNF_Formula constructor
+    /*! \param inst the clause arrays of the formula
+     *  \param ctx output sink and random number generator of the instance
+     */
+    CNF_Formula(const WcnfInstance &inst,
+                const SolverContext &ctx = SolverContext())
+        : ctx(ctx) {
+        initialize(inst);
+    }
+    //! get the output sink and random number generator of the instance
+    inline SolverContext &context() { return ctx; }
     //! get the weight of clauses containing i used in inconsistent subformulas
     /*! \param i the literal for which the weight should be returned
      */
@@ -2606,55 +2685,55 @@ true);
     inline bool isWeighted() const { return isWcnf; }
 
     // mullzhang's additon
+    //! get the best assignment found in the original variable numbering
+    /*! \returns a vector whose entry i-1 is 1 if variable i is true and -1
+     * otherwise; variables which do not occur in the formula are true
+     */
     inline vector<int> getSolution() const {
-        vector<int> solution(nVars);
-        int j = 0;
-
-        set<int> used;
-        for (int i = 1; i <= nVars; ++i) used.insert(mapping[i]);
+        vector<int> solution(maxVn, 1);
         for (int i = 1; i <= maxVn; ++i)
-            if (used.find(i) != used.end()) {
-                ++j;
-                assert(j <= nVars);
-                solution[j - 1] = (int)bestA[j];
-            }
-
+            if (maps_to[i] > 0) solution[i - 1] = (int)bestA[maps_to[i]];
         return solution;
     }
 
+    //! get the value of variable i in the best assignment found
+    /*! \returns 1 if it is true, -1 if it is false and 0 if no assignment
+     * has been found yet
+     */
+    inline int getBestValue(int i) const {
+        return solutionCost < hard ? bestA[i] : 0;
+    }
+
     //! print the optimal solution in the maxsat evaluation format
     inline void printSolution() const {
-        printf("c total generalized unit propagation = %d, success = %.2lf%%\n",
-               total_gup, 100.0 * (1.0 - succ_gup / total_gup));
-#ifdef STATS
-        printf("c number of nodes expanded per level:\n");
-        for (int i = 1; i <= nVars; ++i) {
-            if (explored[i] > 0)
-                printf("c depth %d: %d %lld\n", i, explored[i],
-                       sum_cost[i] / explored[i]);
+        ctx.print(
+            "c total generalized unit propagation = %d, success = %.2lf%%\n",
+            total_gup, 100.0 * (1.0 - (double)succ_gup / total_gup));
+        if (Config::stats) {
+            ctx.print("c number of nodes expanded per level:\n");
+            for (int i = 1; i <= nVars; ++i) {
+                if (explored[i] > 0)
+                    ctx.print("c depth %d: %d %lld\n", i, explored[i],
+                              sum_cost[i] / explored[i]);
+            }
         }
-#endif
-        if (bestCost == hard) {
-            puts("s UNSATISFIABLE");
+        // bestCost may have been lowered by setUpperBound without an
+        // assignment of that cost
+        if (solutionCost == hard) {
+            ctx.print("s UNSATISFIABLE\n");
             return;
         }
         // we assume here that printSolution is only called at the end
-        puts("s OPTIMUM FOUND");
-        printf("c Optimal Solution = %llu\nv", bestCost);
-        int j = 0;
-        set<int> used;
-        for (int i = 1; i <= nVars; ++i) used.insert(mapping[i]);
+        ctx.print("s OPTIMUM FOUND\n");
+        ctx.print("c Optimal Solution = %llu\nv", solutionCost);
         for (int i = 1; i <= maxVn; ++i)
             // if variable i did not occur in the formula, assign it to true
-            if (used.find(i) == used.end()) printf(" %d", i);
+            if (maps_to[i] < 0) ctx.print(" %d", i);
             // otherwise take sign from the best assignment found (bestA)
-            else {
-                ++j;
-                assert(j <= nVars);
-                printf(" %d", (int)bestA[j] * mapping[j]);
-            }
-        assert(j == nVars);
-        putchar('\n');
+            else
+                ctx.print(" %d", (int)bestA[maps_to[i]] * i);
+        ctx.print("\n");
+        ctx.flush();
     }
     //! get number of clauses of literal L
     /*! \param L literal to which the number of clauses should be returned
@@ -2663,8 +2742,8 @@ true);
         assert(!assigned_values[abs(L)]);
 #ifndef NDEBUG
         TL sum = 0;
-        for (vector<int>::const_iterator it = appears[L].begin();
-             it != appears[L].end(); ++it)
+        for (const int *it = appears[L].begin(), *end = appears[L].end();
+             it != end; ++it)
             if (all_clauses.getDeleteFlag(*it) == false &&
                 all_clauses.getLength(*it) > 1)
                 sum += all_clauses.getWeight(*it);
@@ -2685,8 +2764,8 @@ true);
     inline TL getBinaryLength(int L) const {
 #ifndef NDEBUG
         TL sum = 0;
-        for (vector<int>::const_iterator it = appears[L].begin();
-             it != appears[L].end(); ++it)
+        for (const int *it = appears[L].begin(), *end = appears[L].end();
+             it != end; ++it)
             if (!all_clauses.getDeleteFlag(*it) &&
                 all_clauses.getLength(*it) == 2)
                 sum += all_clauses.getWeight(*it);
@@ -2717,35 +2796,41 @@ true);
         deleteFulfilled(L);
         // remove literal -L from clauses
         assigned_values[abs(L)] = L > 0 ? 1 : -1;
+        // swap the variable behind the unassigned ones
+        int last = free_vars[nVars - n_assigned - 1], p = free_pos[abs(L)];
+        free_vars[p] = last;
+        free_pos[last] = p;
+        free_vars[nVars - n_assigned - 1] = abs(L);
+        free_pos[abs(L)] = nVars - n_assigned - 1;
         assigned_literals[n_assigned++] = L;
         all_clauses.assignVariable(-L);
         removeLiteral(-L);
-#ifdef STATS
-        ++explored[n_assigned];
-        sum_cost[n_assigned] += cost[n_assigned];
-        if (n_assigned == nVars) {
-            int mexpl = 0;
-            for (int i = 1; i <= nVars; ++i) {
-                if (explored[i] >= explored[mexpl]) mexpl = i;
-                /*
-                if (explored[i] > 0)
-                        printf("c depth %d: %d %llu\n", i, explored[i],
-                sum_cost[i]/explored[i]);
-                */
+        if (Config::stats) {
+            ++explored[n_assigned];
+            sum_cost[n_assigned] += cost[n_assigned];
+            if (n_assigned == nVars) {
+                int mexpl = 0;
+                for (int i = 1; i <= nVars; ++i) {
+                    if (explored[i] >= explored[mexpl]) mexpl = i;
+                    /*
+                    if (explored[i] > 0)
+                            ctx.print("c depth %d: %d %llu\n", i, explored[i],
+                    sum_cost[i]/explored[i]);
+                    */
+                }
+                ctx.print("c maximum explored in depth %d\n", mexpl);
+                //		for (int i=1; i<=nVars; ++i)
+                //			sum_cost[i] = explored[i] = 0;
             }
-            printf("c maximum explored in depth %d\n", mexpl);
-            //		for (int i=1; i<=nVars; ++i)
-            //			sum_cost[i] = explored[i] = 0;
         }
-#endif
         // is it a complete assignment?
         if (n_assigned == nVars) {
             memcpy(bestA, assigned_values, sizeof(char) * (nVars + 1));
-            bestCost = cost[n_assigned];
-            printf("o %llu\n", bestCost);
+            bestCost = solutionCost = cost[n_assigned];
+            ctx.print("o %llu\n", bestCost);
             // for debugging reasons one may print intermediate solutions
             //		printSolution();
-            fflush(stdout);
+            ctx.flush();
         }
         return true;
     }
@@ -2760,32 +2845,35 @@ true);
         cout << "unassign literal " << L << endl;
 #endif
         restoreClauses(L);
+        // the variable is still right behind the unassigned variables
+        assert(free_vars[nVars - n_assigned] == abs(L));
         --n_assigned;
         assigned_values[abs(L)] = 0;
         assert(appears_len[L] == (int)appears[L].size());
         // add literal -L back to clauses
         addLiteral(-L);
         // remove delete flag from clauses which become unfulfilled
-        for (vector<int>::const_iterator it = appears[L].begin();
-             it != appears[L].end(); ++it) {
-            int l = all_clauses.getLength(*it);
+        // positions are used since clauses may be pushed to other lists
+        for (int j = 0; j < appears[L].size(); ++j) {
+            int c = appears[L][j];
+            int l = all_clauses.getLength(c);
             if (l == 1) {
-                assert(!all_clauses.getDeleteFlag(*it));
+                assert(!all_clauses.getDeleteFlag(c));
                 continue;
             }
             assert(l > 1);
-            assert(all_clauses.getDeleteFlag(*it));
-            assert(!all_clauses.getSpecialFlag(*it));
-            const int_c *literals = all_clauses.getLiterals(*it);
-            assert(all_clauses.getWeight(*it) > 0);
+            assert(all_clauses.getDeleteFlag(c));
+            assert(!all_clauses.getSpecialFlag(c));
+            const int_c *literals = all_clauses.getLiterals(c);
+            assert(all_clauses.getWeight(c) > 0);
             if (l == 2) {
-                W_binary[literals[0]] += all_clauses.getWeight(*it);
-                W_binary[literals[1]] += all_clauses.getWeight(*it);
+                W_binary[literals[0]] += all_clauses.getWeight(c);
+                W_binary[literals[1]] += all_clauses.getWeight(c);
             } else if (l >= 3) {
-                ULL w = all_clauses.getWeight(*it);
+                ULL w = all_clauses.getWeight(c);
                 for (int i = 0; i < l; ++i) W_large[literals[i]] += w;
             }
-            all_clauses.removeDeleteFlagFromClause(*it);
+            all_clauses.removeDeleteFlagFromClause(c);
             // check if we need to reinsert it into appears lists
             for (int i = 0; i < l; ++i) {
                 if (literals[i] == L) continue;
@@ -2800,10 +2888,10 @@ true);
                 assert(!assigned_values[abs(literals[i])]);
 #ifndef NDEBUG
                 bool found = false;
-                for (vector<int>::const_iterator it2 =
-                         appears[literals[i]].begin();
-                     it2 != appears[literals[i]].end(); ++it2)
-                    if (*it2 == *it) {
+                for (const int *it2 = appears[literals[i]].begin(),
+                               *end = appears[literals[i]].end();
+                     it2 != end; ++it2)
+                    if (*it2 == c) {
                         found = true;
                         break;
                     }
@@ -2814,12 +2902,12 @@ true);
 #ifndef NDEBUG
                     if (found)
                         printf("%d %llu %lld %lld\n", l,
-                               all_clauses.getWeight(*it),
+                               all_clauses.getWeight(c),
                                appears_traversed[literals[i]],
                                appears_traversed[L]);
                     assert(!found);
 #endif
-                    appears[literals[i]].push_back(*it);
+                    appears[literals[i]].push_back(c);
                     ++appears_len[literals[i]];
                 }
 #ifndef NDEBUG
@@ -2835,56 +2923,59 @@ true);
      * transformations with inference rules
      */
     ULL bestMinusLowerBound() {
-#ifdef RBFS
-        if (n_assigned == nVars) return cost[n_assigned];
-        needed_for_skip = MAXWEIGHT - cost[n_assigned];
-#else
-        needed_for_skip = bestCost - cost[n_assigned];
-#endif
+        if (Config::bestFirst) {
+            if (n_assigned == nVars) return cost[n_assigned];
+            needed_for_skip = MAXWEIGHT - cost[n_assigned];
+        } else {
+            // bestCost may have been lowered below cost by setUpperBound
+            needed_for_skip =
+                cost[n_assigned] < bestCost ? bestCost - cost[n_assigned] : 0;
+        }
         changed.clear();
         assert(n_assigned < nVars);
-        if (!needed_for_skip) return 0;
+        if (!needed_for_skip) {
+            // no assignment is better than the best one
+            if (n_assigned == 0) raiseLowerBound(bestCost);
+            return 0;
+        }
         ++timestamp;
 #ifdef DEBUG
         cout << "compute lower bound" << endl;
 #endif
 #ifndef NDEBUG
-        for (int i = 1; i <= nVars; ++i)
-            if (!assigned_values[i])
-                assert(literal_data[i] <= 0 && literal_data[-i] <= 0);
+        for (int k = 0; k < nVars - n_assigned; ++k)
+            assert(literal_data[free_vars[k]] <= 0 &&
+                   literal_data[-free_vars[k]] <= 0);
 #endif
         // binary resolution of clauses (i, x) and (-i, x)
         // ternary resolution of clauses (i, x, y) (-i, x, y)
-        for (int i = 1; i <= nVars; ++i) {
-            if (assigned_values[i]) continue;
+        int n_free = nVars - n_assigned;
+        for (int k = 0; k < n_free; ++k) {
+            int i = free_vars[k];
             W_lb[i] = W_lb[-i] = 0;
             assert(W_unit[i] == W_unit_save[i]);
             //		if (n_assigned <= nVars/3) {
             W_unit[i] += binary_ternary_resolution(i);
-#ifdef PROP_LIST
             // check if the literal i can be propagated
-            if (onstack[i] < 0 &&
+            if (Config::propList && onstack[i] < 0 &&
                 W_unit[i] + (TL)cost[n_assigned] >= (TL)bestCost) {
                 onstack[i] = propagation_stack_size;
                 propagation_stack[propagation_stack_size++] = i;
             }
-#endif
             assert(W_unit[-i] == W_unit_save[-i]);
             W_unit[-i] += binary_ternary_resolution(-i);
-#ifdef PROP_LIST
             // check if the literal -i can be propagated
-            if (onstack[-i] < 0 &&
+            if (Config::propList && onstack[-i] < 0 &&
                 W_unit[i] + (TL)cost[n_assigned] >= (TL)bestCost) {
                 onstack[-i] = propagation_stack_size;
                 propagation_stack[propagation_stack_size++] = -i;
             }
-#endif
             //		}
         }
         // now save information to be able to restore the old clause data
         //	if (n_assigned <= nVars/3)
-        for (int i = 1; i <= nVars && needed_for_skip > 0; ++i) {
-            if (assigned_values[i]) continue;
+        for (int k = 0; k < n_free && needed_for_skip > 0; ++k) {
+            int i = free_vars[k];
             TL mw = min(W_unit[i], W_unit[-i]);
             TL t1 = W_unit[i] - W_unit_save[i];
             TL t2 = W_unit[-i] - W_unit_save[-i];
@@ -2957,15 +3048,15 @@ true);
             assert(!all_clauses.getDeleteFlag(*it));
         }
         ULL ret = needed_for_skip;
-        for (int i = 1; i <= nVars; ++i) {
-            if (assigned_values[i]) continue;
+        for (int k = 0; k < n_free; ++k) {
+            int i = free_vars[k];
 #ifndef NDEBUG
-            for (vector<int>::const_iterator it = appears[i].begin();
-                 it != appears[i].end(); ++it)
+            for (const int *it = appears[i].begin(), *end = appears[i].end();
+                 it != end; ++it)
                 assert(all_clauses.getSavedWeight(*it) ==
                        all_clauses.getWeight(*it));
-            for (vector<int>::const_iterator it = appears[-i].begin();
-                 it != appears[-i].end(); ++it)
+            for (const int *it = appears[-i].begin(), *end = appears[-i].end();
+                 it != end; ++it)
                 assert(all_clauses.getSavedWeight(*it) ==
                        all_clauses.getWeight(*it));
 #endif
@@ -2987,12 +3078,12 @@ true);
             // it may be possible that we still can do unary resolution here
             unary_resolution(i);
         }
-        if (n_assigned == 0)
-            printf("c first lower bound: %llu\n",
-                   (unsigned long long)(bestCost - ret));
-#ifdef RBFS
-        return MAXWEIGHT - ret;
-#endif
+        ULL lb = (Config::bestFirst ? MAXWEIGHT : bestCost) - ret;
+        if (n_assigned == 0) {
+            ctx.print("c first lower bound: %llu\n", (unsigned long long)lb);
+            raiseLowerBound(lb);
+        }
+        if (Config::bestFirst) return lb;
         return ret;
     }
     //! CNF_Formula destructor
@@ -3000,25 +3091,19 @@ true);
 #ifdef DEBUG
         printf("c finished with timestamp %lld\n", timestamp);
 #endif
-#ifdef FUIP
-        printf("c fuip statistics: %.2lf%% cases had improvements\n",
-               (100.0 * succ_cnt_fuip) / total_cnt_fuip);
-        delete[] tadj;
+        if (Config::fuip)
+            ctx.print("c fuip statistics: %.2lf%% cases had improvements\n",
+                      (100.0 * succ_cnt_fuip) / total_cnt_fuip);
         delete[] visit2;
         delete[] Q2;
         delete[] ref_cnt;
-#endif
-#ifdef STATS
         delete[] sum_cost;
         delete[] explored;
-#endif
         // subtract nVars to get to the beginning of the arrays
         W_unit -= nVars;
         W_binary -= nVars;
         W_large -= nVars;
         W_unit_save -= nVars;
-        appears -= nVars;
-        unit_implication_list -= nVars;
         appears_traversed -= nVars;
         literal_data -= nVars;
         W_lb -= nVars;
@@ -3029,39 +3114,68 @@ true);
         delete[] Q;
         delete[] literal_order;
         delete[] literal_data;
-        delete[] ternary_clause_data;
         delete[] assigned_values;
         delete[] W_binary;
         delete[] W_large;
         delete[] W_unit_save;
         delete[] appears_traversed;
-        delete[] appears;
-        delete[] unit_implication_list;
         delete[] assigned_literals;
+        delete[] free_vars;
+        delete[] free_pos;
         delete[] W_unit;
         delete[] mapping;
         delete[] maps_to;
         delete[] bestA;
         delete[] W_lb;
         delete[] cost;
-#ifdef PROP_LIST
-        onstack -= nVars;
+        if (Config::propList) onstack -= nVars;
         delete[] onstack;
         delete[] propagation_stack;
-#endif
     }
     inline ULL getHardWeight() const { return hard; }
     //! return the best cost of a complete assignment found so far
     inline ULL getBestCost() const { return bestCost; }
+    //! return the cost of the assignment returned by getSolution
+    inline ULL getSolutionCost() const { return solutionCost; }
+    //! lower the upper bound to the cost of an assignment found elsewhere
+    /*! \param ub the new upper bound; ignored if not below bestCost
+     *  \remark may only be called between two nodes of the search
+     */
+    inline void setUpperBound(ULL ub) {
+        if (ub < bestCost) bestCost = ub;
+    }
+    //! get the lower bound computed at the root of the search
+    inline ULL getLowerBound() const { return lowerBound; }
+    //! raise the lower bound to a bound proven elsewhere
+    /*! \param lb the new lower bound; ignored if not above lowerBound
+     */
+    inline void raiseLowerBound(ULL lb) {
+        if (lb > lowerBound) lowerBound = lb;
+    }
+    //! get the i-th assigned literal, in the order of assignment
+    inline int getAssignedLiteral(int i) const {
+        assert(i >= 0 && i < n_assigned);
+        return assigned_literals[i];
+    }
     //! initialize the best assignment to the assignment of besta
-    inline void saveBest(ULL best, char *besta) {
+    inline void saveBest(ULL best, const char *besta) {
         assert(best <= bestCost);
-        bestCost = best;
+        bestCost = solutionCost = best;
         for (int i = 1; i <= maxVn; ++i)
             if (maps_to[i] > 0) bestA[maps_to[i]] = besta[i];
     }
-#ifdef PROP_LIST
+    //! initialize the best assignment to an assignment found elsewhere
+    /*! \param start the assignment in the original variable numbering
+     *  \returns false iff start is not cheaper than the best assignment
+     */
+    inline bool saveBest(const Assignment &start) {
+        if (start.cost >= bestCost) return false;
+        saveBest(start.cost, start.values.data());
+        return true;
+    }
     //! check if a literal can be propagated because there is a hard unit clause
+    /*! \returns 0 if there is none or Config::propList is not set
+     */
     inline int propagateLiteral() {
         int L;
         // check the literals on the propagation stack if they can still be
@@ -3079,7 +3193,6 @@ true);
         }
         return 0;
     }
-#endif
 };
 
 #endif
@@ -0,0 +1,278 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPRESSED_INPUT_HPP_INCLUDE
+#define COMPRESSED_INPUT_HPP_INCLUDE
+
+#include <stdio.h>
+#include <string.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "dimacs_parser.hpp"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+
+using namespace std;
+
+/*! \file compressed_input.hpp Documentation of class ChunkQueue
+ */
+//! ChunkQueue passes the decompressed pieces of a file from the thread
+//! which decompresses it to the thread which parses it; the number of
+//! pieces waiting is bounded, so that the decompression does not run ahead
+class ChunkQueue {
+    //! protects chunks, closed and cancelled
+    mutex m;
+    //! signalled when a chunk was added or removed, or the queue was closed
+    //! or cancelled
+    condition_variable cv;
+    //! pieces which were not parsed yet
+    deque<string> chunks;
+    //! set by the producer after the last piece
+    bool closed;
+    //! set by the consumer when it does not take more pieces
+    bool cancelled;
+
+   public:
+    //! maximum number of pieces waiting
+    static const size_t CAPACITY = 4;
+    //! size of a piece
+    static const size_t CHUNK_SIZE = 1 << 22;
+
+    ChunkQueue() : closed(false), cancelled(false) {}
+
+    //! add a piece, waiting while the queue is full
+    /*! \returns false if the consumer has cancelled
+     */
+    bool push(string &chunk) {
+        unique_lock<mutex> lock(m);
+        while (chunks.size() >= CAPACITY && !cancelled) cv.wait(lock);
+        if (cancelled) return false;
+        chunks.push_back(string());
+        chunks.back().swap(chunk);
+        cv.notify_all();
+        return true;
+    }
+    //! take the next piece, waiting while the queue is empty
+    /*! \returns false if the queue was closed and all pieces were taken
+     */
+    bool pop(string &chunk) {
+        unique_lock<mutex> lock(m);
+        while (chunks.empty() && !closed) cv.wait(lock);
+        if (chunks.empty()) return false;
+        chunk.swap(chunks.front());
+        chunks.pop_front();
+        cv.notify_all();
+        return true;
+    }
+    //! called by the producer after the last piece
+    void close() {
+        lock_guard<mutex> lock(m);
+        closed = true;
+        cv.notify_all();
+    }
+    //! called by the consumer to stop the producer
+    void cancel() {
+        lock_guard<mutex> lock(m);
+        cancelled = true;
+        chunks.clear();
+        cv.notify_all();
+    }
+};
+
+//! compression formats recognized by their leading bytes
+enum Compression { NO_COMPRESSION, GZIP, XZ };
+
+//! determine the compression format of a file from its leading bytes
+inline Compression compression(FILE *file) {
+    unsigned char magic[6];
+    size_t n = fread(magic, 1, sizeof(magic), file);
+    rewind(file);
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) return GZIP;
+    if (n == 6 && !memcmp(magic, "\xfd" "7zXZ\0", 6)) return XZ;
+    return NO_COMPRESSION;
+}
+
+#ifdef HAVE_ZLIB
+//! decompress a gzip file, which may consist of several members
+/*! \returns false if the file is corrupt
+ */
+inline bool gunzip(FILE *file, ChunkQueue &queue) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // 32 selects automatic detection of the gzip header
+    if (inflateInit2(&zs, 15 + 32) != Z_OK) return false;
+    string in(1 << 20, '\0'), out;
+    // true if the input ends after a complete member, and if inflate
+    // filled the output, so that it may hold back more output
+    bool complete = false, full = false, ok = true;
+    while (ok) {
+        if (zs.avail_in == 0 && !full) {
+            zs.avail_in = (uInt)fread(&in[0], 1, in.size(), file);
+            zs.next_in = (Bytef *)&in[0];
+            if (zs.avail_in == 0) break;
+        }
+        if (out.empty()) {
+            out.resize(ChunkQueue::CHUNK_SIZE);
+            zs.next_out = (Bytef *)&out[0];
+            zs.avail_out = (uInt)out.size();
+        }
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        // Z_BUF_ERROR means that inflate had nothing to do
+        if (ret != Z_BUF_ERROR) complete = ret == Z_STREAM_END;
+        if (ret == Z_STREAM_END) ret = inflateReset(&zs);
+        ok = ret == Z_OK || ret == Z_BUF_ERROR;
+        full = zs.avail_out == 0;
+        if (ok && full) ok = queue.push(out);
+    }
+    ok = ok && complete && ferror(file) == 0;
+    if (ok && !out.empty()) {
+        out.resize(out.size() - zs.avail_out);
+        ok = queue.push(out);
+    }
+    inflateEnd(&zs);
+    return ok;
+}
+#endif
+
+#ifdef HAVE_LZMA
+//! decompress an xz file, which may consist of several streams
+/*! \returns false if the file is corrupt
+ */
+inline bool unxz(FILE *file, ChunkQueue &queue) {
+    lzma_stream xs = LZMA_STREAM_INIT;
+    if (lzma_stream_decoder(&xs, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+        return false;
+    string in(1 << 20, '\0'), out;
+    lzma_action action = LZMA_RUN;
+    lzma_ret ret = LZMA_OK;
+    bool ok = true;
+    while (ok && ret != LZMA_STREAM_END) {
+        if (xs.avail_in == 0 && action == LZMA_RUN) {
+            xs.avail_in = fread(&in[0], 1, in.size(), file);
+            xs.next_in = (const uint8_t *)&in[0];
+            if (xs.avail_in == 0) action = LZMA_FINISH;
+        }
+        if (out.empty()) {
+            out.resize(ChunkQueue::CHUNK_SIZE);
+            xs.next_out = (uint8_t *)&out[0];
+            xs.avail_out = out.size();
+        }
+        ret = lzma_code(&xs, action);
+        ok = ret == LZMA_OK || ret == LZMA_STREAM_END;
+        if (ok && (xs.avail_out == 0 || ret == LZMA_STREAM_END)) {
+            out.resize(out.size() - xs.avail_out);
+            ok = queue.push(out);
+        }
+    }
+    ok = ok && ferror(file) == 0;
+    lzma_end(&xs);
+    return ok;
+}
+#endif
+
+//! read a compressed file in DIMACS cnf/wcnf format
+/*! The file is decompressed on a separate thread, and the pieces are
+ *  parsed while the next ones are decompressed.
+ *  \param file the file, positioned at its start
+ *  \param format the compression format of the file
+ *  \param inst receives the clauses
+ *  \returns false if the file is corrupt or on a parse error
+ */
+inline bool readCompressedDimacs(FILE *file, Compression format,
+                                 WcnfInstance &inst) {
+    ChunkQueue queue;
+    bool decompressed = false;
+    thread producer([&]() {
+#ifdef HAVE_ZLIB
+        if (format == GZIP) decompressed = gunzip(file, queue);
+#endif
+#ifdef HAVE_LZMA
+        if (format == XZ) decompressed = unxz(file, queue);
+#endif
+        queue.close();
+    });
+    DimacsParser parser(inst);
+    string rest, chunk;
+    bool parsed = true;
+    while (parsed && queue.pop(chunk)) {
+        // the incomplete line at the end of the previous piece comes first
+        if (rest.empty())
+            rest.swap(chunk);
+        else
+            rest.append(chunk);
+        const char *stop =
+            parser.feed(rest.data(), rest.data() + rest.size(), false);
+        parsed = stop != NULL;
+        if (parsed) rest.erase(0, stop - rest.data());
+    }
+    if (!parsed) queue.cancel();
+    producer.join();
+    if (parsed && !decompressed) {
+        fprintf(stderr, "Parse error: corrupt compressed input\n");
+        return false;
+    }
+    return parsed &&
+           parser.feed(rest.data(), rest.data() + rest.size(), true) !=
+               NULL &&
+           parser.finish();
+}
+
+//! read a file in DIMACS cnf/wcnf format, which may be compressed with gzip
+//! or xz
+/*! The compression is recognized by the leading bytes of the file;
+ *  uncompressed files are mapped into memory.
+ *  \param filename the name of the file
+ *  \param inst receives the clauses
+ *  \returns false if the file cannot be read or on a parse error
+ */
+inline bool readDimacsInput(const string &filename, WcnfInstance &inst) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Parse error: cannot open %s\n", filename.c_str());
+        return false;
+    }
+    Compression format = compression(file);
+    bool supported = format == NO_COMPRESSION;
+#ifdef HAVE_ZLIB
+    supported = supported || format == GZIP;
+#endif
+#ifdef HAVE_LZMA
+    supported = supported || format == XZ;
+#endif
+    bool parsed = false;
+    if (!supported)
+        fprintf(stderr, "Parse error: %s input is not supported\n",
+                format == GZIP ? "gzip" : "xz");
+    else if (format != NO_COMPRESSION)
+        parsed = readCompressedDimacs(file, format, inst);
+    fclose(file);
+    if (format == NO_COMPRESSION) parsed = readDimacsFile(filename, inst);
+    return parsed;
+}
+
+#endif
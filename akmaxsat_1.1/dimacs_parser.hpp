@@ -0,0 +1,304 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DIMACS_PARSER_HPP_INCLUDE
+#define DIMACS_PARSER_HPP_INCLUDE
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "wcnf_instance.hpp"
+
+using namespace std;
+
+/*! \file dimacs_parser.hpp Documentation of class DimacsParser
+ */
+//! DimacsParser reads a formula in DIMACS cnf/wcnf format from memory
+//! buffers, appending the literals, lengths and weights of the clauses
+//! directly to the arrays of a WcnfInstance
+/*! The input can be given in pieces: each call of feed consumes the complete
+ * lines of its buffer and leaves the rest for the next call, so that no
+ * number is split between two buffers.
+ *
+ * Files without a parameter line are read in the newer wcnf format, in which
+ * hard clauses start with "h" instead of a weight. Their weight is set to
+ * the total weight of the soft clauses plus one when the input ends.
+ */
+class DimacsParser {
+    //! receives the clauses
+    WcnfInstance &inst;
+    //! number of clauses announced by the parameter line, -1 before it
+    //! and INT_MAX without it
+    int nClauses;
+    //! true if the input has no parameter line
+    bool headerless;
+    //! index of the first clause in inst
+    size_t firstClause;
+    //! number of clauses read
+    int nRead;
+    //! start of the clause being read in inst.literals
+    size_t clauseStart;
+    //! weight of the clause being read, 0 if it was not read yet
+    ULL weight;
+    //! true if the clause being read was marked as hard by "h"
+    bool hardClause;
+    //! total weight of the soft clauses read, at most MAXWEIGHT
+    ULL softWeight;
+    //! true after an error was reported
+    bool failed;
+
+    //! report a parse error
+    bool error(const char *message) {
+        fprintf(stderr, "Parse error: %s\n", message);
+        failed = true;
+        return false;
+    }
+    //! read the parameter line [p, eol)
+    void readHeader(const char *p, const char *eol) {
+        string line(p, eol);
+        char type[100];
+        int nVars, n;
+        ULL top;
+        int t = sscanf(line.c_str(), "p %99s %d %d %llu", type, &nVars, &n,
+                       &top);
+        if (t < 3) return;
+        inst.weighted = !strcmp(type, "wcnf");
+        if (!inst.weighted && strcmp(type, "cnf")) {
+            error("unknown format in the parameter line");
+            return;
+        }
+        inst.maxVn = max(inst.maxVn, nVars);
+        inst.hard = t == 3 ? 0 : top;
+        nClauses = n;
+        inst.lengths.reserve(n);
+        inst.weights.reserve(n);
+    }
+    //! start reading a file without a parameter line
+    void startHeaderless() {
+        headerless = true;
+        nClauses = INT_MAX;
+        inst.weighted = true;
+        inst.hard = 0;
+    }
+    //! end the clause being read; hard clauses of a file without parameter
+    //! line get the weight 0 until the input ends
+    void endClause() {
+        ULL w = hardClause ? 0 : inst.weighted ? weight : 1;
+        if (!hardClause && (!inst.hard || w < inst.hard))
+            softWeight += min(w, MAXWEIGHT - softWeight);
+        inst.lengths.push_back((int)(inst.literals.size() - clauseStart));
+        inst.weights.push_back(w);
+        clauseStart = inst.literals.size();
+        weight = 0;
+        hardClause = false;
+        ++nRead;
+    }
+    //! read the numbers and comment lines in [p, end), which ends between
+    //! two numbers
+    bool readClauses(const char *p, const char *end) {
+        while (p != end && nRead < nClauses) {
+            if ((unsigned char)*p <= ' ') {
+                ++p;
+                continue;
+            }
+            if (*p == 'c') {
+                const char *eol = (const char *)memchr(p, '\n', end - p);
+                p = eol ? eol : end;
+                continue;
+            }
+            if (*p == 'h' && headerless && !hardClause && weight == 0 &&
+                inst.literals.size() == clauseStart) {
+                if (++p != end && (unsigned char)*p > ' ')
+                    return error("unexpected character");
+                hardClause = true;
+                continue;
+            }
+            bool negative = *p == '-';
+            if (negative) ++p;
+            // 18 digits always fit into MAXWEIGHT, so that only longer
+            // numbers need a check for each digit
+            const char *first = p;
+            ULL x = 0;
+            while (p != end && (unsigned char)(*p - '0') < 10 &&
+                   p - first < 18)
+                x = x * 10 + (unsigned char)(*p++ - '0');
+            while (p != end && (unsigned char)(*p - '0') < 10) {
+                ULL d = (unsigned char)(*p++ - '0');
+                if (x > (MAXWEIGHT - d) / 10)
+                    return error("number out of range");
+                x = x * 10 + d;
+            }
+            if (p == first || (p != end && (unsigned char)*p > ' '))
+                return error("unexpected character");
+            if (inst.weighted && weight == 0 && !hardClause) {
+                if (negative || x == 0) return error("weight is not positive");
+                weight = x;
+            } else if (x == 0)
+                endClause();
+            else {
+                if (x > INT_MAX) return error("variable out of range");
+                if ((int)x > inst.maxVn) inst.maxVn = (int)x;
+                inst.literals.push_back(negative ? -(int_c)x : (int_c)x);
+            }
+        }
+        return true;
+    }
+
+   public:
+    //! DimacsParser constructor
+    /*! \param inst receives the clauses
+     */
+    explicit DimacsParser(WcnfInstance &inst)
+        : inst(inst),
+          nClauses(-1),
+          headerless(false),
+          firstClause(inst.weights.size()),
+          nRead(0),
+          clauseStart(inst.literals.size()),
+          weight(0),
+          hardClause(false),
+          softWeight(0),
+          failed(false) {}
+
+    //! parse a piece of the input
+    /*! \param p the start of the piece
+     *  \param end the end of the piece
+     *  \param last true if the input ends with this piece
+     *  \returns the end of the consumed part of the piece, which has to be
+     *  given again at the start of the next piece; NULL on a parse error
+     */
+    const char *feed(const char *p, const char *end, bool last) {
+        if (failed) return NULL;
+        // consume complete lines only, unless the input ends here
+        const char *stop = end;
+        if (!last) {
+            while (stop != p && stop[-1] != '\n') --stop;
+            end = stop;
+        }
+        // look for the parameter line, skipping the comment lines before
+        // it; a clause before it starts a file without parameter line
+        while (nClauses < 0 && p != end) {
+            const char *eol = (const char *)memchr(p, '\n', end - p);
+            if (eol == NULL) eol = end;
+            const char *q = p;
+            while (q != eol && (unsigned char)*q <= ' ') ++q;
+            if (eol - p >= 2 && p[0] == 'p' && p[1] == ' ')
+                readHeader(p, eol);
+            else if (q != eol && *q != 'c' && *q != 'p') {
+                startHeaderless();
+                break;
+            }
+            if (failed) return NULL;
+            p = eol == end ? end : eol + 1;
+        }
+        if (nClauses >= 0 && !readClauses(p, end)) return NULL;
+        return stop;
+    }
+    //! check the formula after the last piece was given
+    /*! \returns false if there are no clauses and no parameter line, if
+     *  the formula has fewer clauses than its parameter line announces or
+     *  if the total weight of its soft clauses is not below MAXWEIGHT
+     */
+    bool finish() {
+        if (failed) return false;
+        if (nClauses < 0)
+            return error("did not find the parameter line");
+        // the last clause may miss its terminating 0
+        if (nRead < nClauses &&
+            (inst.literals.size() > clauseStart || weight || hardClause))
+            endClause();
+        if (!headerless && nRead < nClauses) return error("missing clauses");
+        // costs up to the hard weight have to be representable
+        if (softWeight >= MAXWEIGHT)
+            return error("total weight of the soft clauses is too large");
+        if (headerless) {
+            for (size_t i = firstClause; i < inst.weights.size(); ++i)
+                if (inst.weights[i] == 0) {
+                    inst.weights[i] = softWeight + 1;
+                    inst.hard = softWeight + 1;
+                }
+        }
+        return true;
+    }
+};
+
+//! read a formula in DIMACS cnf/wcnf format
+/*! \param istr the input stream from which the formula is read
+ *  \param inst receives the clauses
+ *  \returns false on a parse error
+ */
+inline bool readDimacs(istream &istr, WcnfInstance &inst) {
+    DimacsParser parser(inst);
+    const size_t CHUNK = 1 << 20;
+    string buffer;
+    size_t filled = 0;
+    bool last = false;
+    while (!last) {
+        if (buffer.size() < filled + CHUNK) buffer.resize(filled + CHUNK);
+        istr.read(&buffer[filled], CHUNK);
+        filled += istr.gcount();
+        last = !istr;
+        const char *begin = buffer.data();
+        const char *stop = parser.feed(begin, begin + filled, last);
+        if (stop == NULL) return false;
+        buffer.erase(0, stop - begin);
+        filled -= stop - begin;
+    }
+    return parser.finish();
+}
+
+//! read a file in DIMACS cnf/wcnf format by mapping it into memory
+/*! Files which cannot be mapped, such as pipes, are read as a stream.
+ *  \param filename the name of the file
+ *  \param inst receives the clauses
+ *  \returns false if the file cannot be opened or on a parse error
+ */
+inline bool readDimacsFile(const string &filename, WcnfInstance &inst) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Parse error: cannot open %s\n", filename.c_str());
+        return false;
+    }
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        ifstream istr(filename.c_str());
+        return readDimacs(istr, inst);
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    DimacsParser parser(inst);
+    const char *begin = (const char *)data;
+    bool parsed = parser.feed(begin, begin + st.st_size, true) != NULL &&
+                  parser.finish();
+    munmap(data, st.st_size);
+    return parsed;
+}
+
+#endif
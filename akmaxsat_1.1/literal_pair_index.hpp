@@ -0,0 +1,114 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LITERAL_PAIR_INDEX_HPP_INCLUDE
+#define LITERAL_PAIR_INDEX_HPP_INCLUDE
+
+#include <assert.h>
+#include <stddef.h>
+
+#include <vector>
+
+using namespace std;
+
+/*! \file literal_pair_index.hpp Documentation of class LiteralPairIndex
+ */
+//! LiteralPairIndex maps pairs of literals to clause ids by open addressing
+//! with linear probing; its memory grows with the number of pairs stored
+//! rather than with the square of the number of variables. The slots in use
+//! are logged, so clear restores the empty table in time proportional to the
+//! number of entries
+class LiteralPairIndex {
+    //! the literal pair stored in each slot, 0 if there is none (literals
+    //! are never 0)
+    vector<unsigned long long> keys;
+    //! the clause id stored in each slot
+    vector<int> values;
+    //! slots in use, in order of insertion
+    vector<size_t> used;
+    //! log2 of the number of slots
+    int bits;
+
+    //! combine the literals a and b to a key
+    static inline unsigned long long key(int a, int b) {
+        return (unsigned long long)(unsigned)a << 32 | (unsigned)b;
+    }
+    //! first slot probed for key k
+    inline size_t slot(unsigned long long k) const {
+        return (size_t)((k * 0x9e3779b97f4a7c15ULL) >> (64 - bits));
+    }
+    //! find the slot of key k, or the empty slot where it would be inserted
+    inline size_t probe(unsigned long long k) const {
+        size_t mask = keys.size() - 1, i = slot(k);
+        while (keys[i] != k && keys[i] != 0) i = (i + 1) & mask;
+        return i;
+    }
+    //! double the number of slots and reinsert all entries
+    void grow() {
+        vector<unsigned long long> oldKeys(2 * keys.size(), 0);
+        vector<int> oldValues(2 * keys.size(), 0);
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        ++bits;
+        for (size_t j = 0; j < used.size(); ++j) {
+            size_t i = probe(oldKeys[used[j]]);
+            keys[i] = oldKeys[used[j]];
+            values[i] = oldValues[used[j]];
+            used[j] = i;
+        }
+    }
+
+   public:
+    LiteralPairIndex() : keys(16, 0), values(16, 0), bits(4) {}
+
+    //! get the clause id stored for the literals a and b
+    /*! \returns a reference to the stored id; a pair which was not stored
+     * before is inserted with id 0
+     */
+    inline int &operator()(int a, int b) {
+        unsigned long long k = key(a, b);
+        size_t i = probe(k);
+        if (keys[i] == 0) {
+            // keep the load factor at most 1/2
+            if (2 * (used.size() + 1) > keys.size()) {
+                grow();
+                i = probe(k);
+            }
+            keys[i] = k;
+            values[i] = 0;
+            used.push_back(i);
+        }
+        return values[i];
+    }
+    //! get the clause id stored for the literals a and b
+    /*! \returns a pointer to the stored id, NULL if the pair is not stored
+     */
+    inline int *find(int a, int b) {
+        size_t i = probe(key(a, b));
+        return keys[i] == 0 ? NULL : &values[i];
+    }
+    //! get the number of literal pairs stored
+    inline size_t size() const { return used.size(); }
+    //! remove all literal pairs
+    inline void clear() {
+        for (size_t j = 0; j < used.size(); ++j) keys[used[j]] = 0;
+        used.clear();
+    }
+};
+
+#endif
@@ -0,0 +1,289 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LOCAL_SEARCH_HPP_INCLUDE
+#define LOCAL_SEARCH_HPP_INCLUDE
+
+#include <limits.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "solver_context.hpp"
+#include "wcnf_instance.hpp"
+
+using namespace std;
+
+/*! \file local_search.hpp Documentation of class LocalSearch
+ */
+//! LocalSearch looks for a cheap complete assignment by tabu search; its
+//! result serves as initial upper bound of the branch and bound
+class LocalSearch {
+    //! maximum variable index
+    int nVars;
+    //! variables which occur in some clause
+    vector<int> used;
+    //! offsets of the clauses in lits
+    vector<int> start;
+    //! literals of the clauses without duplicates and tautologies
+    vector<int_c> lits;
+    //! weight of each clause; hard clauses weigh more than all soft ones
+    vector<long long> weight;
+    //! offsets of the clause lists of literal L in occ at index L + nVars
+    vector<int> occStart;
+    //! clauses containing each literal
+    vector<int> occ;
+    //! value of each variable, 1 for true and -1 for false
+    vector<char> value;
+    //! number of true literals in each clause
+    vector<int> nTrue;
+    //! sum of the variables of the true literals in each clause; identifies
+    //! the true literal if there is only one
+    vector<long long> trueSum;
+    //! change of cost when flipping each variable
+    vector<long long> score;
+    //! step until which flipping each variable is forbidden
+    vector<long long> tabu;
+    //! weight of the clauses violated by value
+    long long cost;
+
+    //! check if literal L is true under value
+    inline bool isTrue(int L) const { return (L > 0) == (value[abs(L)] > 0); }
+    //! first clause of literal L
+    inline const int *occBegin(int L) const {
+        return occ.data() + occStart[L + nVars];
+    }
+    //! end of the clauses of literal L
+    inline const int *occEnd(int L) const {
+        return occ.data() + occStart[L + nVars + 1];
+    }
+    //! add w to the scores of all variables of clause c
+    inline void addScore(int c, long long w) {
+        for (int j = start[c]; j < start[c + 1]; ++j) score[abs(lits[j])] += w;
+    }
+    //! compute clause states, scores and cost from value
+    void init() {
+        fill(score.begin(), score.end(), 0);
+        cost = 0;
+        for (int c = 0; c + 1 < (int)start.size(); ++c) {
+            nTrue[c] = 0;
+            trueSum[c] = 0;
+            for (int j = start[c]; j < start[c + 1]; ++j)
+                if (isTrue(lits[j])) {
+                    ++nTrue[c];
+                    trueSum[c] += abs(lits[j]);
+                }
+            if (nTrue[c] == 0) {
+                // flipping any variable satisfies the clause
+                cost += weight[c];
+                addScore(c, -weight[c]);
+            } else if (nTrue[c] == 1)
+                // flipping the only true literal violates the clause
+                score[trueSum[c]] += weight[c];
+        }
+    }
+    //! flip variable v and update clause states, scores and cost
+    void flip(int v) {
+        value[v] = -value[v];
+        int L = value[v] > 0 ? v : -v;
+        // clauses in which L became true
+        for (const int *it = occBegin(L); it != occEnd(L); ++it) {
+            int c = *it;
+            long long w = weight[c];
+            if (nTrue[c] == 0) {
+                cost -= w;
+                addScore(c, w);
+                score[v] += w;
+            } else if (nTrue[c] == 1)
+                score[trueSum[c]] -= w;
+            ++nTrue[c];
+            trueSum[c] += v;
+        }
+        // clauses in which -L became false
+        for (const int *it = occBegin(-L); it != occEnd(-L); ++it) {
+            int c = *it;
+            long long w = weight[c];
+            --nTrue[c];
+            trueSum[c] -= v;
+            if (nTrue[c] == 0) {
+                cost += w;
+                addScore(c, -w);
+                score[v] -= w;
+            } else if (nTrue[c] == 1)
+                score[trueSum[c]] += w;
+        }
+    }
+
+   public:
+    //! LocalSearch constructor
+    /*! \param inst the formula
+     */
+    explicit LocalSearch(const WcnfInstance &inst)
+        : nVars(inst.maxVn),
+          occStart(2 * inst.maxVn + 2, 0),
+          value(inst.maxVn + 1, 1),
+          score(inst.maxVn + 1, 0),
+          tabu(inst.maxVn + 1, 0),
+          cost(0) {
+        ULL soft = 0;
+        for (int i = 0; i < inst.nClauses(); ++i)
+            if (!inst.hard || inst.weights[i] < inst.hard)
+                soft += inst.weights[i];
+        // violating a hard clause is worse than violating all soft ones
+        long long penalty = (long long)min(soft + 1, (ULL)LLONG_MAX / 4);
+        vector<int_c> clause;
+        vector<char> occurs(nVars + 1, 0);
+        vector<int_c>::const_iterator lit = inst.literals.begin();
+        start.push_back(0);
+        for (int i = 0; i < inst.nClauses(); ++i) {
+            clause.assign(lit, lit + inst.lengths[i]);
+            lit += inst.lengths[i];
+            sort(clause.begin(), clause.end());
+            clause.erase(unique(clause.begin(), clause.end()), clause.end());
+            bool tautology = false;
+            for (int j = 0; j < (int)clause.size(); ++j)
+                if (binary_search(clause.begin(), clause.end(), -clause[j]))
+                    tautology = true;
+            // clauses without literals do not depend on the assignment
+            if (tautology || clause.empty()) continue;
+            for (int j = 0; j < (int)clause.size(); ++j) {
+                ++occStart[clause[j] + nVars + 1];
+                occurs[abs(clause[j])] = 1;
+            }
+            lits.insert(lits.end(), clause.begin(), clause.end());
+            start.push_back((int)lits.size());
+            bool hard = inst.hard && inst.weights[i] >= inst.hard;
+            weight.push_back(hard ? penalty
+                                  : (long long)min(inst.weights[i],
+                                                   (ULL)penalty));
+        }
+        for (int v = 1; v <= nVars; ++v)
+            if (occurs[v]) used.push_back(v);
+        for (int i = 1; i < (int)occStart.size(); ++i)
+            occStart[i] += occStart[i - 1];
+        occ.resize(lits.size());
+        vector<int> fillPos(occStart.begin(), occStart.end() - 1);
+        for (int c = 0; c + 1 < (int)start.size(); ++c)
+            for (int j = start[c]; j < start[c + 1]; ++j)
+                occ[fillPos[lits[j] + nVars]++] = c;
+        nTrue.resize(weight.size());
+        trueSum.resize(weight.size());
+    }
+
+    //! run the tabu search from a random or a given assignment
+    /*! \param rng the random number generator
+     *  \param deadline the search stops at this point of time
+     *  \param steps maximum number of flips
+     *  \param best receives the cheapest assignment found; its cost is
+     *  given in the weights of the search, in which hard clauses weigh less
+     *  than in the formula
+     *  \param from optional assignment to start from instead of a random one
+     */
+    void run(mt19937_64 &rng, chrono::steady_clock::time_point deadline,
+             long long steps, Assignment &best,
+             const vector<char> *from = NULL) {
+        int n = (int)used.size();
+        for (int i = 0; i < n; ++i)
+            value[used[i]] =
+                from != NULL ? (*from)[used[i]] : rng() & 1 ? 1 : -1;
+        init();
+        fill(tabu.begin(), tabu.end(), 0);
+        long long bestCost = cost;
+        best.values = value;
+        // restart from a perturbed best assignment after stall steps without
+        // improvement
+        long long stall = 10LL * n + 100, last = 0;
+        int tenure = min(n / 4, 20) + 1;
+        for (long long step = 1; step <= steps && n > 0; ++step) {
+            if (!(step & 63) && chrono::steady_clock::now() >= deadline) break;
+            int v = 0, ties = 0;
+            long long vs = LLONG_MAX;
+            for (int i = 0; i < n; ++i) {
+                int u = used[i];
+                if (score[u] > vs) continue;
+                // a tabu flip is allowed if it finds a new best assignment
+                if (tabu[u] > step && cost + score[u] >= bestCost) continue;
+                if (score[u] < vs) {
+                    vs = score[u];
+                    v = u;
+                    ties = 1;
+                } else if (rng() % ++ties == 0)
+                    v = u;
+            }
+            if (v == 0) continue;
+            flip(v);
+            tabu[v] = step + tenure + (long long)(rng() % 10);
+            if (cost < bestCost) {
+                bestCost = cost;
+                best.values = value;
+                last = step;
+            } else if (step - last > stall) {
+                value = best.values;
+                for (int i = 0; i <= n / 10; ++i) {
+                    int u = used[rng() % n];
+                    value[u] = -value[u];
+                }
+                init();
+                last = step;
+            }
+        }
+        best.cost = (ULL)bestCost;
+    }
+};
+
+//! run independent tabu searches in several threads
+/*! \param inst the formula
+ *  \param nthreads number of threads
+ *  \param deadline the searches stop at this point of time
+ *  \param ctx output sink; the random number generators of the searches
+ *  are seeded from it
+ *  \param best receives the cheapest assignment found and its cost
+ *  \param init optional assignment from which the first search starts
+ *  \returns false iff no assignment satisfying the hard clauses was found
+ */
+inline bool local_search(const WcnfInstance &inst, int nthreads,
+                         chrono::steady_clock::time_point deadline,
+                         SolverContext &ctx, Assignment &best,
+                         const Assignment *init = NULL) {
+    vector<Assignment> results(nthreads);
+    vector<thread> threads;
+    for (int i = 0; i < nthreads; ++i) {
+        unsigned long long seed = ctx.rng();
+        const vector<char> *from =
+            i == 0 && init != NULL ? &init->values : NULL;
+        threads.push_back(thread([&inst, &results, deadline, i, seed, from]() {
+            mt19937_64 rng(seed);
+            LocalSearch ls(inst);
+            ls.run(rng, deadline, 1000 + 100LL * inst.maxVn, results[i], from);
+        }));
+    }
+    for (int i = 0; i < nthreads; ++i) threads[i].join();
+    int w = 0;
+    for (int i = 1; i < nthreads; ++i)
+        if (results[i].cost < results[w].cost) w = i;
+    best.values.swap(results[w].values);
+    best.cost = evaluate(inst, best.values);
+    ctx.print("c local search cost: %llu\n", best.cost);
+    return !inst.hard || best.cost < inst.hard;
+}
+
+#endif
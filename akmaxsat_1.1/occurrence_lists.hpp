@@ -0,0 +1,200 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OCCURRENCE_LISTS_HPP_INCLUDE
+#define OCCURRENCE_LISTS_HPP_INCLUDE
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+using namespace std;
+
+/*! \file occurrence_lists.hpp Documentation of class OccurrenceLists
+ */
+//! OccurrenceLists stores lists of ints, such as the clauses of each literal,
+//! in compressed sparse row format: all lists share one contiguous array in
+//! which each list owns a range given by its offset, length and capacity. A
+//! list which outgrows its range moves to the end of the array; the array is
+//! compacted when the abandoned ranges take more space than the lists.
+/*! Pointers into the lists are invalidated by push_back on any list, while
+ * positions within a list stay valid.
+ */
+class OccurrenceLists {
+    //! the range of a list in data
+    struct Range {
+        size_t start;
+        int len;
+        int cap;
+        Range() : start(0), len(0), cap(0) {}
+    };
+    //! storage of all lists
+    vector<int> data;
+    //! range of list i at index i + offset
+    vector<Range> ranges;
+    //! smallest list index
+    int offset;
+    //! number of entries in data which no list owns
+    size_t garbage;
+
+    //! move list k to the end of data with capacity cap
+    void relocate(int k, int cap) {
+        Range &r = ranges[k];
+        if (r.start + r.cap == data.size())
+            // the list is the last one, so it only needs to be extended
+            data.resize(r.start + cap);
+        else {
+            size_t start = data.size();
+            data.resize(start + cap);
+            if (r.len)
+                memcpy(&data[start], &data[r.start], sizeof(int) * r.len);
+            garbage += r.cap;
+            r.start = start;
+        }
+        r.cap = cap;
+    }
+    //! remove the abandoned ranges from data
+    void compact() {
+        vector<int> compacted;
+        size_t size = 0;
+        for (size_t k = 0; k < ranges.size(); ++k)
+            size += ranges[k].len + ranges[k].len / 4;
+        compacted.resize(size);
+        size = 0;
+        for (size_t k = 0; k < ranges.size(); ++k) {
+            Range &r = ranges[k];
+            if (r.len)
+                memcpy(&compacted[size], &data[r.start], sizeof(int) * r.len);
+            r.start = size;
+            r.cap = r.len + r.len / 4;
+            size += r.cap;
+        }
+        data.swap(compacted);
+        garbage = 0;
+    }
+    //! give list k a capacity of at least cap
+    void grow(int k, int cap) {
+        if (garbage > data.size() / 2) compact();
+        if (ranges[k].cap < cap) relocate(k, cap);
+    }
+
+   public:
+    //! the list with index k of an OccurrenceLists; it offers the part of the
+    //! interface of vector<int> used by the solver
+    class List {
+        OccurrenceLists *lists;
+        int k;
+
+       public:
+        List(OccurrenceLists *lists, int k) : lists(lists), k(k) {}
+        inline int size() const { return lists->ranges[k].len; }
+        inline bool empty() const { return lists->ranges[k].len == 0; }
+        inline int *begin() const {
+            return lists->data.data() + lists->ranges[k].start;
+        }
+        inline int *end() const { return begin() + size(); }
+        inline reverse_iterator<int *> rbegin() const {
+            return reverse_iterator<int *>(end());
+        }
+        inline reverse_iterator<int *> rend() const {
+            return reverse_iterator<int *>(begin());
+        }
+        inline int &operator[](int i) const {
+            assert(i >= 0 && i < size());
+            return begin()[i];
+        }
+        inline int &back() const { return (*this)[size() - 1]; }
+        inline void pop_back() const {
+            assert(size() > 0);
+            --lists->ranges[k].len;
+        }
+        inline void clear() const { lists->ranges[k].len = 0; }
+        //! shorten the list to n ints
+        inline void resize(int n) const {
+            assert(n <= size());
+            lists->ranges[k].len = n;
+        }
+        inline void push_back(int x) const {
+            Range &r = lists->ranges[k];
+            if (r.len == r.cap) lists->grow(k, 2 * r.cap + 2);
+            lists->data[r.start + r.len++] = x;
+        }
+        //! append the ints in [first, last), which must not point into the
+        //! lists
+        template <class It>
+        void append(It first, It last) const {
+            int n = (int)distance(first, last);
+            Range &r = lists->ranges[k];
+            if (r.len + n > r.cap) lists->grow(k, 2 * (r.len + n));
+            copy(first, last, end());
+            r.len += n;
+        }
+        //! replace the list by the ints in [first, last)
+        template <class It>
+        void assign(It first, It last) const {
+            clear();
+            append(first, last);
+        }
+    };
+    //! a list of a constant OccurrenceLists
+    class ConstList {
+        const OccurrenceLists *lists;
+        int k;
+
+       public:
+        ConstList(const OccurrenceLists *lists, int k) : lists(lists), k(k) {}
+        inline int size() const { return lists->ranges[k].len; }
+        inline bool empty() const { return lists->ranges[k].len == 0; }
+        inline const int *begin() const {
+            return lists->data.data() + lists->ranges[k].start;
+        }
+        inline const int *end() const { return begin() + size(); }
+        inline int operator[](int i) const {
+            assert(i >= 0 && i < size());
+            return begin()[i];
+        }
+    };
+
+    OccurrenceLists() : offset(0), garbage(0) {}
+
+    //! create empty lists with indices first to last
+    void init(int first, int last) {
+        offset = -first;
+        ranges.assign(last - first + 1, Range());
+        data.clear();
+        garbage = 0;
+    }
+    //! lay out the list with index i at the end of the array with space for
+    //! n ints; calling this for all lists in order of their indices before
+    //! filling them gives the lists a contiguous layout
+    void reserve(int i, int n) {
+        if (ranges[i + offset].cap < n) relocate(i + offset, n);
+    }
+    //! get the list with index i
+    inline List operator[](int i) { return List(this, i + offset); }
+    //! get the list with index i
+    inline ConstList operator[](int i) const {
+        return ConstList(this, i + offset);
+    }
+};
+
+#endif
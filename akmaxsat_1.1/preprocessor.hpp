@@ -0,0 +1,417 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PREPROCESSOR_HPP_INCLUDE
+#define PREPROCESSOR_HPP_INCLUDE
+
+#include <assert.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "wcnf_instance.hpp"
+
+using namespace std;
+
+/*! \file preprocessor.hpp Documentation of class Preprocessor
+ */
+//! Preprocessor simplifies a weighted formula before the search. Only hard
+//! clauses, which every feasible assignment satisfies, are used to simplify
+//! other clauses: hard unit clauses are propagated, hard clauses remove the
+//! clauses they subsume and strengthen clauses by self-subsuming resolution,
+//! and variables which only occur in hard clauses are eliminated by
+//! resolution if this does not increase the number of clauses. Pure literals
+//! are set regardless of the weights, and duplicate clauses are merged.
+/*! The simplified formula keeps the variable numbering of the input. Its
+ * cost plus the weight of the clauses which became empty is the cost of the
+ * input for every feasible assignment which reconstruct completes, and no
+ * feasible assignment of the input is cheaper than the optimum of the
+ * simplified formula plus that weight.
+ */
+class Preprocessor {
+    //! a clause which has to be satisfied when the solution is completed,
+    //! by setting its witness literal if necessary
+    struct Eliminated {
+        int witness;
+        size_t start;
+        int len;
+    };
+    //! lexicographic order of clauses given by their indices
+    struct ClauseLess {
+        const vector<vector<int_c> > &clause;
+        explicit ClauseLess(const vector<vector<int_c> > &clause)
+            : clause(clause) {}
+        bool operator()(int a, int b) const { return clause[a] < clause[b]; }
+    };
+    //! number of variables
+    int nVars;
+    //! weight of hard clauses, 0 if there are none
+    ULL hard;
+    //! start of the literals of each clause in lits
+    vector<size_t> start;
+    //! number of literals of each clause; a clause keeps its start when
+    //! literals are removed from it
+    vector<int> len;
+    //! literals of all clauses, sorted by variable within each clause
+    vector<int_c> lits;
+    //! weight of each clause
+    vector<ULL> weight;
+    //! true for clauses which were removed
+    vector<char> removed;
+    //! clauses of each literal; may contain removed clauses
+    vector<vector<int> > occ;
+    //! value of each variable: 1 if it was set to true, -1 if it was set to
+    //! false, 2 if it was eliminated and 0 otherwise
+    vector<char> value;
+    //! marks of the literals of the clause being compared
+    vector<char> mark;
+    //! clauses which may have become hard units
+    vector<int> units;
+    //! hard clauses which may subsume or strengthen other clauses
+    vector<int> subsuming;
+    //! true for the clauses in subsuming
+    vector<char> queued;
+    //! the clauses to be satisfied when the solution is completed, in the
+    //! order in which they were removed
+    vector<Eliminated> stack;
+    //! literals of the clauses on the stack
+    vector<int_c> stackLits;
+    //! weight of the clauses which became empty
+    ULL constant;
+    //! true if the formula was changed
+    bool changed;
+
+    //! maximum number of literals of a resolvent
+    static const int MAX_RESOLVENT = 20;
+    //! maximum number of clauses of a variable to be eliminated
+    static const int MAX_OCCURRENCES = 16;
+    //! maximum number of clauses compared with a subsuming clause
+    static const size_t MAX_CANDIDATES = 1000;
+
+    //! index of literal L in occ and mark
+    static inline int index(int L) { return 2 * abs(L) + (L < 0); }
+    inline bool isHard(int c) const { return hard && weight[c] >= hard; }
+    inline const int_c *begin(int c) const { return &lits[start[c]]; }
+    inline const int_c *end(int c) const { return &lits[start[c]] + len[c]; }
+    static bool byVariable(int a, int b) {
+        return abs(a) < abs(b) || (abs(a) == abs(b) && a < b);
+    }
+
+    //! add a clause
+    /*! \param clause the literals of the clause, sorted by variable and
+     *  without repetitions or complementary literals
+     */
+    void addClause(const vector<int_c> &clause, ULL w) {
+        int c = (int)len.size();
+        start.push_back(lits.size());
+        len.push_back((int)clause.size());
+        lits.insert(lits.end(), clause.begin(), clause.end());
+        weight.push_back(w);
+        removed.push_back(0);
+        queued.push_back(0);
+        for (size_t j = 0; j < clause.size(); ++j)
+            occ[index(clause[j])].push_back(c);
+        touch(c);
+    }
+    //! queue a clause which was added or strengthened
+    void touch(int c) {
+        if (!isHard(c)) return;
+        if (len[c] == 1) units.push_back(c);
+        if (!queued[c]) {
+            queued[c] = 1;
+            subsuming.push_back(c);
+        }
+    }
+    //! remove a clause; with a witness it is put on the stack
+    void removeClause(int c, int witness = 0) {
+        assert(!removed[c]);
+        removed[c] = 1;
+        changed = true;
+        if (!witness) return;
+        Eliminated e = {witness, stackLits.size(), len[c]};
+        stackLits.insert(stackLits.end(), begin(c), end(c));
+        stack.push_back(e);
+    }
+    //! remove literal L from clause c
+    void strengthen(int c, int L) {
+        int_c *first = &lits[start[c]], *last = first + len[c];
+        int_c *p = find(first, last, L);
+        assert(p != last);
+        copy(p + 1, last, p);
+        --len[c];
+        changed = true;
+        vector<int> &list = occ[index(L)];
+        list.erase(find(list.begin(), list.end(), c));
+        if (len[c] == 0) {
+            // every assignment which extends the values set violates it
+            constant += min(weight[c], MAXWEIGHT - constant);
+            removed[c] = 1;
+        } else
+            touch(c);
+    }
+    //! drop the removed clauses from the list of literal L
+    vector<int> &clauses(int L) {
+        vector<int> &list = occ[index(L)];
+        size_t k = 0;
+        for (size_t j = 0; j < list.size(); ++j)
+            if (!removed[list[j]]) list[k++] = list[j];
+        list.resize(k);
+        return list;
+    }
+    //! set literal L to true
+    void assign(int L) {
+        value[abs(L)] = L > 0 ? 1 : -1;
+        Eliminated e = {L, stackLits.size(), 1};
+        stackLits.push_back(L);
+        stack.push_back(e);
+        changed = true;
+        vector<int> &sat = clauses(L);
+        for (size_t j = 0; j < sat.size(); ++j) removed[sat[j]] = 1;
+        sat.clear();
+        vector<int> falsified = clauses(-L);
+        for (size_t j = 0; j < falsified.size(); ++j)
+            strengthen(falsified[j], -L);
+    }
+    //! set the literals of the hard unit clauses
+    void propagate() {
+        while (!units.empty()) {
+            int c = units.back();
+            units.pop_back();
+            if (removed[c] || len[c] != 1 || value[abs(lits[start[c]])])
+                continue;
+            assign(lits[start[c]]);
+        }
+    }
+    //! compare clause c, whose literals are marked, with clause d
+    /*! \returns 0 if c does not subsume d, INT_MIN if it does and literal L
+     *  of d if c subsumes d with L replaced by -L
+     */
+    int compare(int c, int d) const {
+        int flipped = 0, found = 0;
+        for (const int_c *p = begin(d); p != end(d); ++p) {
+            if (mark[index(*p)])
+                ++found;
+            else if (mark[index(-*p)] && !flipped) {
+                flipped = *p;
+                ++found;
+            }
+        }
+        if (found < len[c]) return 0;
+        return flipped ? flipped : INT_MIN;
+    }
+    //! remove the clauses which the hard clause c subsumes and strengthen
+    //! those from which self-subsuming resolution with c removes a literal
+    void subsume(int c) {
+        // the candidates contain the variable of c with the fewest clauses
+        int best = 0;
+        size_t fewest = 0;
+        for (const int_c *p = begin(c); p != end(c); ++p) {
+            size_t n = clauses(*p).size() + clauses(-*p).size();
+            if (!best || n < fewest) {
+                best = *p;
+                fewest = n;
+            }
+        }
+        if (fewest > MAX_CANDIDATES) return;
+        for (const int_c *p = begin(c); p != end(c); ++p) mark[index(*p)] = 1;
+        for (int sign = 1; sign >= -1; sign -= 2) {
+            // strengthening shrinks the list of -best while it is scanned
+            vector<int> candidates = clauses(sign * best);
+            for (size_t j = 0; j < candidates.size() && !removed[c]; ++j) {
+                int d = candidates[j];
+                if (d == c || removed[d] || len[d] < len[c]) continue;
+                int r = compare(c, d);
+                if (r == INT_MIN)
+                    removeClause(d);
+                else if (r)
+                    strengthen(d, r);
+            }
+        }
+        for (const int_c *p = begin(c); p != end(c); ++p) mark[index(*p)] = 0;
+    }
+    //! eliminate variable v by resolution if it only occurs in hard clauses
+    //! and the resolvents are not more than its clauses
+    bool eliminate(int v) {
+        vector<int> &pos = clauses(v), &neg = clauses(-v);
+        int n = (int)(pos.size() + neg.size());
+        if (n == 0 || n > MAX_OCCURRENCES) return false;
+        for (size_t j = 0; j < pos.size(); ++j)
+            if (!isHard(pos[j])) return false;
+        for (size_t j = 0; j < neg.size(); ++j)
+            if (!isHard(neg[j])) return false;
+        vector<vector<int_c> > resolvents;
+        vector<int_c> r;
+        for (size_t a = 0; a < pos.size(); ++a)
+            for (size_t b = 0; b < neg.size(); ++b) {
+                if (!resolve(pos[a], neg[b], v, r)) continue;
+                if ((int)resolvents.size() == n ||
+                    (int)r.size() > MAX_RESOLVENT)
+                    return false;
+                resolvents.push_back(r);
+            }
+        value[v] = 2;
+        // the clauses of v are satisfied after -v is set
+        vector<int> keep = pos, other = neg;
+        for (size_t j = 0; j < keep.size(); ++j) removeClause(keep[j], v);
+        for (size_t j = 0; j < other.size(); ++j) removed[other[j]] = 1;
+        Eliminated e = {-v, stackLits.size(), 1};
+        stackLits.push_back(-v);
+        stack.push_back(e);
+        for (size_t k = 0; k < resolvents.size(); ++k)
+            addClause(resolvents[k], hard);
+        return true;
+    }
+    //! resolve clauses c and d on variable v
+    /*! \returns false if the resolvent is a tautology
+     */
+    bool resolve(int c, int d, int v, vector<int_c> &r) const {
+        r.clear();
+        const int_c *p = begin(c), *q = begin(d);
+        while (p != end(c) || q != end(d)) {
+            if (p != end(c) && abs(*p) == v) {
+                ++p;
+                continue;
+            }
+            if (q != end(d) && abs(*q) == v) {
+                ++q;
+                continue;
+            }
+            if (q == end(d) || (p != end(c) && abs(*p) < abs(*q)))
+                r.push_back(*p++);
+            else if (p == end(c) || abs(*q) < abs(*p))
+                r.push_back(*q++);
+            else if (*p == *q) {
+                r.push_back(*p++);
+                ++q;
+            } else
+                return false;
+        }
+        return true;
+    }
+    //! set variable v if it occurs with one sign only
+    bool setPure(int v) {
+        bool pos = !clauses(v).empty(), neg = !clauses(-v).empty();
+        if (pos == neg) return false;
+        assign(pos ? v : -v);
+        return true;
+    }
+
+   public:
+    //! load the clauses of inst, normalizing them and merging duplicates
+    explicit Preprocessor(const WcnfInstance &inst)
+        : nVars(inst.maxVn),
+          hard(inst.hard),
+          occ(2 * inst.maxVn + 2),
+          value(inst.maxVn + 1, 0),
+          mark(2 * inst.maxVn + 2, 0),
+          constant(0),
+          changed(false) {
+        vector<int> order;
+        vector<vector<int_c> > clause(inst.nClauses());
+        vector<int_c>::const_iterator lit = inst.literals.begin();
+        for (int i = 0; i < inst.nClauses(); ++i) {
+            vector<int_c> &cl = clause[i];
+            cl.assign(lit, lit + inst.lengths[i]);
+            lit += inst.lengths[i];
+            sort(cl.begin(), cl.end(), byVariable);
+            cl.erase(unique(cl.begin(), cl.end()), cl.end());
+            bool tautology = false;
+            for (size_t j = 1; j < cl.size(); ++j)
+                if (cl[j] == -cl[j - 1]) tautology = true;
+            if (tautology) continue;
+            if (cl.empty())
+                constant += min(inst.weights[i], MAXWEIGHT - constant);
+            else
+                order.push_back(i);
+        }
+        changed = (int)order.size() < inst.nClauses();
+        // equal clauses are adjacent in lexicographic order
+        sort(order.begin(), order.end(), ClauseLess(clause));
+        for (size_t k = 0; k < order.size();) {
+            ULL w = 0;
+            size_t l = k;
+            for (; l < order.size() && clause[order[l]] == clause[order[k]];
+                 ++l)
+                w += min(inst.weights[order[l]], MAXWEIGHT - w);
+            changed = changed || l > k + 1;
+            addClause(clause[order[k]], w);
+            k = l;
+        }
+    }
+
+    //! simplify the formula until no rule applies
+    void run() {
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            propagate();
+            while (!subsuming.empty()) {
+                int c = subsuming.back();
+                subsuming.pop_back();
+                queued[c] = 0;
+                if (!removed[c]) subsume(c);
+                propagate();
+            }
+            for (int v = 1; v <= nVars; ++v) {
+                if (value[v]) continue;
+                if (setPure(v) || (hard && eliminate(v))) {
+                    progress = true;
+                    propagate();
+                }
+            }
+        }
+    }
+    //! get the simplified formula
+    /*! \param reduced receives the remaining clauses, in the variable
+     *  numbering of the input
+     *  \returns the weight of the clauses which every completed assignment
+     *  violates
+     */
+    ULL getFormula(WcnfInstance &reduced) const {
+        reduced = WcnfInstance();
+        reduced.hard = hard;
+        for (int c = 0; c < (int)len.size(); ++c)
+            if (!removed[c]) reduced.addClause(begin(c), len[c], weight[c]);
+        reduced.maxVn = nVars;
+        return constant;
+    }
+    //! check if the formula was changed
+    inline bool wasChanged() const { return changed; }
+    //! complete an assignment of the simplified formula to the input
+    /*! \param values value of variable i at index i, 1 for true and -1 for
+     *  false; the values of the variables which were set or eliminated are
+     *  replaced
+     */
+    void reconstruct(vector<char> &values) const {
+        for (size_t k = stack.size(); k-- > 0;) {
+            const Eliminated &e = stack[k];
+            bool sat = false;
+            for (int j = 0; j < e.len && !sat; ++j) {
+                int L = stackLits[e.start + j];
+                sat = (L > 0) == (values[abs(L)] > 0);
+            }
+            if (!sat) values[abs(e.witness)] = e.witness > 0 ? 1 : -1;
+        }
+    }
+
+};
+
+#endif
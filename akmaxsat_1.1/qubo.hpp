@@ -0,0 +1,172 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QUBO_HPP_INCLUDE
+#define QUBO_HPP_INCLUDE
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "wcnf_instance.hpp"
+
+using namespace std;
+
+/*! \file qubo.hpp Documentation of struct QuboModel and the QUBO encoder
+ */
+//! QuboModel stores the coefficients of a QUBO over binary variables
+//! 0..n-1; every pair (row[k], col[k]) satisfies row[k] < col[k] and occurs
+//! only once
+struct QuboModel {
+    //! number of variables
+    int n;
+    //! linear coefficient of each variable
+    vector<double> linear;
+    //! smaller variable index of each interaction
+    vector<int> row;
+    //! larger variable index of each interaction
+    vector<int> col;
+    //! coefficient of each interaction
+    vector<double> quadratic;
+    //! largest absolute coefficient
+    double maxAbs;
+
+    QuboModel() : n(0), maxAbs(0) {}
+
+    //! build the model from interactions in coordinate format
+    /*! \param n number of variables
+     *  \param lin n linear coefficients
+     *  \param nnz number of interactions
+     *  \param qi, qj, qv the interactions; duplicate and transposed pairs
+     *  are summed up, pairs with qi = qj are added to the linear part
+     */
+    void assignCoo(int n, const double *lin, int nnz, const int *qi,
+                   const int *qj, const double *qv) {
+        this->n = n;
+        linear.assign(lin, lin + n);
+        vector<pair<long long, int> > keys;
+        keys.reserve(nnz);
+        for (int k = 0; k < nnz; ++k) {
+            if (qi[k] < 0 || qi[k] >= n || qj[k] < 0 || qj[k] >= n)
+                throw invalid_argument("invalid quadratic index");
+            if (qi[k] == qj[k])
+                linear[qi[k]] += qv[k];
+            else
+                keys.push_back(make_pair(
+                    (long long)min(qi[k], qj[k]) * n + max(qi[k], qj[k]), k));
+        }
+        sort(keys.begin(), keys.end());
+        row.clear();
+        col.clear();
+        quadratic.clear();
+        // merge duplicate pairs and determine the largest coefficient
+        maxAbs = 0;
+        for (size_t k = 0; k < keys.size();) {
+            long long key = keys[k].first;
+            double v = 0;
+            for (; k < keys.size() && keys[k].first == key; ++k)
+                v += qv[keys[k].second];
+            if (v == 0) continue;
+            row.push_back((int)(key / n));
+            col.push_back((int)(key % n));
+            quadratic.push_back(v);
+            maxAbs = max(maxAbs, fabs(v));
+        }
+        for (int i = 0; i < n; ++i) maxAbs = max(maxAbs, fabs(linear[i]));
+    }
+    //! build the model from interactions in compressed sparse row format
+    /*! \param indptr n+1 offsets into indices and data, starting with 0,
+     *  non-decreasing and ending with nnz
+     *  \param nnz the number of elements of indices and data
+     */
+    void assignCsr(int n, const double *lin, const int *indptr,
+                   const int *indices, const double *data, int nnz) {
+        // check all offsets before the rows are filled from them
+        if (indptr[0] != 0 || indptr[n] != nnz)
+            throw invalid_argument("invalid indptr");
+        for (int i = 0; i < n; ++i)
+            if (indptr[i + 1] < indptr[i])
+                throw invalid_argument("invalid indptr");
+        vector<int> rows(nnz);
+        for (int i = 0; i < n; ++i)
+            fill(rows.begin() + indptr[i], rows.begin() + indptr[i + 1], i);
+        // the column indices are checked by assignCoo
+        assignCoo(n, lin, nnz, rows.data(), indices, data);
+    }
+    //! default precision: keep five significant digits of the largest
+    //! coefficient
+    double defaultPrecision() const {
+        if (maxAbs == 0) return 1;
+        return pow(10.0, floor(log10(maxAbs)) - 4);
+    }
+};
+
+//! encode a QUBO as weighted Max-SAT formula
+/*! literal v of the formula is false iff binary variable v-1 is 1, so that
+ * the cost of an assignment equals the energy up to a constant offset
+ *  \param q the QUBO to be encoded
+ *  \param precision coefficients are rounded to multiples of precision
+ *  \param inst receives one unit clause per variable with non-zero linear
+ *  weight and one binary clause per interaction
+ *  \returns the offset c such that the energy of an assignment with cost w
+ *  is precision * (w + c), up to the rounding of the coefficients
+ */
+inline long long encodeQubo(const QuboModel &q, double precision,
+                            WcnfInstance &inst) {
+    if (!(precision > 0)) throw invalid_argument("precision must be positive");
+    inst.clear();
+    inst.maxVn = q.n;
+    inst.lengths.reserve(q.n + q.quadratic.size());
+    inst.weights.reserve(q.n + q.quadratic.size());
+    inst.literals.reserve(q.n + 2 * q.quadratic.size());
+    vector<long long> lin_weight(q.n);
+    for (int i = 0; i < q.n; ++i)
+        lin_weight[i] = llround(q.linear[i] / precision);
+    int_c clause[2];
+    for (size_t k = 0; k < q.quadratic.size(); ++k) {
+        long long w = llround(q.quadratic[k] / precision);
+        if (w == 0) continue;
+        clause[0] = q.row[k] + 1;
+        if (w > 0)
+            // b x_i x_j is violated iff x_i = x_j = 1
+            clause[1] = q.col[k] + 1;
+        else {
+            // b x_i x_j = b x_i + |b| x_i (1 - x_j)
+            clause[1] = -(q.col[k] + 1);
+            lin_weight[q.row[k]] += w;
+            w = -w;
+        }
+        inst.addClause(clause, 2, (ULL)w);
+    }
+    long long offset = 0;
+    for (int i = 0; i < q.n; ++i) {
+        if (lin_weight[i] == 0) continue;
+        // a x_i with a < 0 equals a + |a| (1 - x_i)
+        clause[0] = lin_weight[i] > 0 ? i + 1 : -(i + 1);
+        inst.addClause(clause, 1, (ULL)llabs(lin_weight[i]));
+        if (lin_weight[i] < 0) offset += lin_weight[i];
+    }
+    return offset;
+}
+
+#endif
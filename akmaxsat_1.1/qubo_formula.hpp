@@ -0,0 +1,632 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QUBO_FORMULA_HPP_INCLUDE
+#define QUBO_FORMULA_HPP_INCLUDE
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "clauses.hpp"
+#include "solver_config.hpp"
+#include "solver_context.hpp"
+#include "wcnf_instance.hpp"
+
+using namespace std;
+
+/*! \file qubo_formula.hpp Documentation of class QuboFormula
+ */
+//! QuboFormula is a formula of weighted unit and binary clauses, as produced
+//! by encodeQubo; it offers the interface of CNF_Formula used by
+//! fast_backtrack. The binary clauses form a weighted implication graph in
+//! compressed sparse row format whose structure never changes: every pair
+//! of variables sharing a clause has a weight for each of the four clauses
+//! over the two variables, so the inference rules of the lower bound only
+//! move weight between these clauses and the unit clauses
+template <class Config = DefaultConfig>
+class QuboFormula {
+    //! output sink and random number generator of this instance
+    SolverContext ctx;
+    //! number of variables in the formula
+    int nVars;
+    //! maximum input variable
+    int maxVn;
+    //! hard clause weight (for partial maxsat)
+    ULL hard;
+    //! boolean flag which indicates if the given formula has weighted clauses
+    bool isWcnf;
+    //! number of an original variable in the compacted variable numbering
+    vector<int> maps_to;
+
+    //! offsets of the neighbours of variable v in adj at index v
+    vector<int> adjStart;
+    //! for each neighbour of a variable: the neighbour, the first clause of
+    //! their pair and 0 if the variable is the smaller one of the pair, 1
+    //! otherwise
+    vector<int> adj;
+    //! the two variables of each pair, the smaller one first
+    vector<int> pairVars;
+    //! weight of the clauses of pair p at 4p + 2a + b, where a (b) is 1 iff
+    //! the literal of the smaller (larger) variable is negative
+    vector<long long> weight;
+
+    //! storage of the literal indexed arrays below
+    vector<long long> literalData;
+    //! weight of unit clauses which contain literal i, including the binary
+    //! clauses shortened to literal i by the assignment
+    long long *W_unit;
+    //! weight of binary clauses of unassigned variables which contain
+    //! literal i
+    long long *W_binary;
+    //! sum of clause weights of clauses containing literal i contained in
+    //! inconsistent subformulas detected in lower bound calculation
+    long long *W_lb;
+    //! residual weight of the unit clauses during lower bound calculation
+    long long *R_unit;
+
+    //! contains the values assigned to the variables
+    vector<char> assigned_values;
+    //! contains the best values assigned to the variables
+    vector<char> bestA;
+    //! stack of assigned literals
+    vector<int> assigned_literals;
+    //! number of assigned literals
+    int n_assigned;
+    //! cost of current partial assignment
+    vector<ULL> cost;
+    //! best cost of a complete assignment
+    ULL bestCost;
+    //! cost of the assignment stored in bestA, hard if there is none
+    ULL solutionCost;
+    //! lower bound on the cost of any complete assignment
+    ULL lowerBound;
+    //! unassigned variables in arbitrary order
+    vector<int> freeVars;
+    //! position of each unassigned variable in freeVars
+    vector<int> freePos;
+
+    //! weight changes of the binary clauses by the inference rules, undone
+    //! when the search backtracks
+    vector<pair<int, long long> > clauseTrail;
+    //! weight changes of the unit clauses by the inference rules
+    vector<pair<int, long long> > unitTrail;
+    //! sizes of clauseTrail and unitTrail when each level was entered
+    vector<pair<int, int> > trailMark;
+
+    //! residual weight of each binary clause during lower bound calculation;
+    //! equal to weight outside of it
+    vector<long long> residual;
+    //! binary clauses whose residual weight was reduced
+    vector<int> touched;
+    //! propagation round in which literal i was set, at index i + nVars
+    vector<int> setIn;
+    //! literal which implied literal i (0 for a unit clause) followed by the
+    //! implying clause, at index 2 * (i + nVars)
+    vector<int> reason;
+    //! breadth-first queue of the unit propagation
+    vector<int> queue;
+    //! current propagation round
+    int round;
+    //! binary clauses of the inconsistent subformula found last
+    vector<int> conflictClauses;
+    //! unit clauses of the inconsistent subformula found last
+    vector<int> conflictUnits;
+
+    //! the clause of literal L of the variable of neighbour entry k and
+    //! literal M of the neighbour
+    inline int clauseOf(const int *k, int L, int M) const {
+        int a = L < 0, b = M < 0;
+        return k[1] + (k[2] ? 2 * b + a : 2 * a + b);
+    }
+    //! literal of the smaller variable in clause c
+    inline int firstLiteral(int c) const {
+        int v = pairVars[2 * (c >> 2)];
+        return c & 2 ? -v : v;
+    }
+    //! literal of the larger variable in clause c
+    inline int secondLiteral(int c) const {
+        int v = pairVars[2 * (c >> 2) + 1];
+        return c & 1 ? -v : v;
+    }
+    //! set a to min(a + b, hard) without overflow
+    inline void saveAddition(ULL &a, ULL b) const {
+        a = b >= hard - min(a, hard) ? hard : a + b;
+    }
+    //! change the weight of clause c of two unassigned variables until the
+    //! search backtracks
+    inline void changeWeight(int c, long long w) {
+        weight[c] += w;
+        residual[c] += w;
+        W_binary[firstLiteral(c)] += w;
+        W_binary[secondLiteral(c)] += w;
+        clauseTrail.push_back(make_pair(c, w));
+    }
+    //! change the weight of the unit clause L until the search backtracks
+    inline void changeUnit(int L, long long w) {
+        W_unit[L] += w;
+        unitTrail.push_back(make_pair(L, w));
+    }
+    //! undo the inference rules applied since the current level was entered
+    void undoChanges() {
+        while ((int)clauseTrail.size() > trailMark[n_assigned].first) {
+            int c = clauseTrail.back().first;
+            long long w = clauseTrail.back().second;
+            weight[c] -= w;
+            residual[c] -= w;
+            W_binary[firstLiteral(c)] -= w;
+            W_binary[secondLiteral(c)] -= w;
+            clauseTrail.pop_back();
+        }
+        while ((int)unitTrail.size() > trailMark[n_assigned].second) {
+            W_unit[unitTrail.back().first] -= unitTrail.back().second;
+            unitTrail.pop_back();
+        }
+    }
+
+    //! build the implication graph from the clauses of inst; the arrays keep
+    //! their memory when the formula is built again
+    void initialize(const WcnfInstance &inst) {
+        pairVars.clear();
+        weight.clear();
+        clauseTrail.clear();
+        unitTrail.clear();
+        touched.clear();
+        conflictClauses.clear();
+        conflictUnits.clear();
+        maxVn = inst.maxVn;
+        hard = inst.hard ? inst.hard : MAXWEIGHT;
+        isWcnf = inst.weighted;
+        maps_to.assign(maxVn + 1, -1);
+        nVars = 0;
+        ULL constant = 0;
+        vector<pair<int, ULL> > units;
+        vector<pair<pair<int, int>, ULL> > binaries;
+        vector<int_c>::const_iterator lit = inst.literals.begin();
+        for (int i = 0; i < inst.nClauses(); ++i) {
+            int len = inst.lengths[i];
+            assert(len <= 2);
+            int c[2] = {0, 0};
+            for (int j = 0; j < len; ++j) {
+                int var = abs(lit[j]);
+                // remap the variables to values between 1 and nVars
+                if (maps_to[var] < 0) maps_to[var] = ++nVars;
+                c[j] = lit[j] > 0 ? maps_to[var] : -maps_to[var];
+            }
+            lit += len;
+            ULL w = inst.weights[i];
+            if (len == 2 && c[0] == c[1]) len = 1;
+            if (len == 0)
+                // clauses without literals are always violated
+                saveAddition(constant, w);
+            else if (len == 1)
+                units.push_back(make_pair(c[0], w));
+            else if (c[0] != -c[1]) {
+                if (abs(c[0]) > abs(c[1])) swap(c[0], c[1]);
+                binaries.push_back(make_pair(make_pair(c[0], c[1]), w));
+            }
+        }
+        if (nVars != maxVn)
+            ctx.print(
+                "c Number of variables occuring in the formula: %d max "
+                "variable = %d -> remapping\n",
+                nVars, maxVn);
+        literalData.assign(4 * (2 * nVars + 1), 0);
+        W_unit = literalData.data() + nVars;
+        W_binary = W_unit + 2 * nVars + 1;
+        W_lb = W_binary + 2 * nVars + 1;
+        R_unit = W_lb + 2 * nVars + 1;
+        for (size_t i = 0; i < units.size(); ++i) {
+            ULL w = (ULL)W_unit[units[i].first];
+            saveAddition(w, units[i].second);
+            W_unit[units[i].first] = (long long)w;
+        }
+        // group the clauses by pairs of variables
+        sort(binaries.begin(), binaries.end(),
+             [](const pair<pair<int, int>, ULL> &x,
+                const pair<pair<int, int>, ULL> &y) {
+                 return make_pair(abs(x.first.first), abs(x.first.second)) <
+                        make_pair(abs(y.first.first), abs(y.first.second));
+             });
+        adjStart.assign(nVars + 2, 0);
+        for (size_t i = 0; i < binaries.size(); ++i) {
+            int a = binaries[i].first.first, b = binaries[i].first.second;
+            if (i == 0 || abs(binaries[i - 1].first.first) != abs(a) ||
+                abs(binaries[i - 1].first.second) != abs(b)) {
+                pairVars.push_back(abs(a));
+                pairVars.push_back(abs(b));
+                weight.resize(weight.size() + 4, 0);
+                adjStart[abs(a) + 1] += 3;
+                adjStart[abs(b) + 1] += 3;
+            }
+            int c = (int)weight.size() - 4 + 2 * (a < 0) + (b < 0);
+            ULL w = (ULL)weight[c];
+            saveAddition(w, binaries[i].second);
+            weight[c] = (long long)w;
+        }
+        for (size_t i = 1; i < adjStart.size(); ++i)
+            adjStart[i] += adjStart[i - 1];
+        adj.resize(adjStart.back());
+        vector<int> fillPos(adjStart.begin(), adjStart.end() - 1);
+        for (int p = 0; p < (int)pairVars.size() / 2; ++p) {
+            int a = pairVars[2 * p], b = pairVars[2 * p + 1];
+            int *k = &adj[fillPos[a]];
+            k[0] = b;
+            k[1] = 4 * p;
+            k[2] = 0;
+            fillPos[a] += 3;
+            k = &adj[fillPos[b]];
+            k[0] = a;
+            k[1] = 4 * p;
+            k[2] = 1;
+            fillPos[b] += 3;
+        }
+        for (int c = 0; c < (int)weight.size(); ++c) {
+            W_binary[firstLiteral(c)] += weight[c];
+            W_binary[secondLiteral(c)] += weight[c];
+        }
+        residual = weight;
+        assigned_values.assign(nVars + 1, 0);
+        bestA.assign(nVars + 1, 0);
+        assigned_literals.resize(nVars);
+        n_assigned = 0;
+        cost.assign(nVars + 1, 0);
+        cost[0] = constant;
+        bestCost = solutionCost = hard;
+        lowerBound = 0;
+        freeVars.resize(nVars);
+        freePos.resize(nVars + 1);
+        for (int i = 1; i <= nVars; ++i) {
+            freeVars[i - 1] = i;
+            freePos[i] = i - 1;
+        }
+        trailMark.assign(nVars + 1, make_pair(0, 0));
+        setIn.assign(2 * nVars + 1, 0);
+        reason.assign(2 * (2 * nVars + 1), 0);
+        queue.resize(2 * nVars);
+        round = 0;
+        // without variables the empty assignment is complete
+        if (nVars == 0) bestCost = solutionCost = min(constant, hard);
+    }
+
+    //! mark literal L as implied by literal from with clause c in this round
+    inline void setLiteral(int L, int from, int c) {
+        setIn[L + nVars] = round;
+        reason[2 * (L + nVars)] = from;
+        reason[2 * (L + nVars) + 1] = c;
+    }
+    //! check if literal L was set in this propagation round
+    inline bool isSet(int L) const { return setIn[L + nVars] == round; }
+    //! collect the clauses which imply literal L in this round
+    /*! \returns true iff the collection reached a unit clause, rather than
+     * a literal collected before
+     */
+    inline bool collectReasons(int L) {
+        // a literal is marked as collected by setting its round to -round
+        while (setIn[L + nVars] == round) {
+            setIn[L + nVars] = -round;
+            int from = reason[2 * (L + nVars)];
+            if (from == 0) {
+                conflictUnits.push_back(L);
+                return true;
+            }
+            conflictClauses.push_back(reason[2 * (L + nVars) + 1]);
+            L = from;
+        }
+        return false;
+    }
+    //! unit propagation from all residual unit clauses
+    /*! \param chain set to true iff the inconsistent subformula is a chain
+     * of implications between two unit clauses
+     *  \returns true iff a conflict was found; its inconsistent subformula
+     * is stored in conflictClauses and conflictUnits
+     */
+    bool detectConflict(bool &chain) {
+        ++round;
+        int head = 0, tail = 0;
+        for (int i = 0; i < (int)freeVars.size(); ++i) {
+            int v = freeVars[i];
+            int L = R_unit[v] > 0 ? v : R_unit[-v] > 0 ? -v : 0;
+            if (L == 0) continue;
+            setLiteral(L, 0, 0);
+            queue[tail++] = L;
+        }
+        while (head < tail) {
+            int L = queue[head++];
+            const int *end = &adj[0] + adjStart[abs(L) + 1];
+            for (const int *k = &adj[0] + adjStart[abs(L)]; k != end; k += 3) {
+                if (assigned_values[k[0]]) continue;
+                // the clauses (-L, u) and (-L, -u)
+                for (int M = k[0]; M != 0; M = M > 0 ? -M : 0) {
+                    int c = clauseOf(k, -L, M);
+                    if (residual[c] == 0 || isSet(M)) continue;
+                    if (isSet(-M)) {
+                        // clause c is violated
+                        conflictClauses.clear();
+                        conflictUnits.clear();
+                        conflictClauses.push_back(c);
+                        chain = collectReasons(L);
+                        chain = collectReasons(-M) && chain;
+                        return true;
+                    }
+                    setLiteral(M, L, c);
+                    queue[tail++] = M;
+                }
+            }
+        }
+        return false;
+    }
+    //! remove the weight of the last inconsistent subformula from the
+    //! residual formula
+    /*! \param chain replace the subformula with the empty clause and the
+     * clauses of the negated literals of its binary clauses, which is
+     * possible for a chain of implications (chain resolution); its weight is
+     * then added to the cost until the search backtracks
+     *  \returns the weight which was removed
+     */
+    long long resolveConflict(bool chain) {
+        long long m = LLONG_MAX;
+        for (size_t i = 0; i < conflictClauses.size(); ++i)
+            m = min(m, residual[conflictClauses[i]]);
+        for (size_t i = 0; i < conflictUnits.size(); ++i)
+            m = min(m, R_unit[conflictUnits[i]]);
+        for (size_t i = 0; i < conflictClauses.size(); ++i) {
+            int c = conflictClauses[i];
+            W_lb[firstLiteral(c)] += m;
+            W_lb[secondLiteral(c)] += m;
+            if (chain) {
+                changeWeight(c, -m);
+                changeWeight(c ^ 3, m);
+            } else {
+                if (residual[c] == weight[c]) touched.push_back(c);
+                residual[c] -= m;
+            }
+        }
+        for (size_t i = 0; i < conflictUnits.size(); ++i) {
+            int L = conflictUnits[i];
+            R_unit[L] -= m;
+            W_lb[L] += m;
+            if (chain) changeUnit(L, -m);
+        }
+        if (chain) saveAddition(cost[n_assigned], (ULL)m);
+        return m;
+    }
+    //! lower bound on the cost of the unassigned variables
+    /*! inference rules may increase the cost of the current assignment
+     * instead, until the search backtracks
+     *  \param needed the search stops as soon as this is reached
+     *  \returns the sum of the increase of the cost and the lower bound
+     */
+    ULL computeLowerBound(ULL needed) {
+        ULL lb = 0;
+        // resolution of the unit clauses i and -i
+        for (int i = 0; i < (int)freeVars.size(); ++i) {
+            int v = freeVars[i];
+            W_lb[v] = W_lb[-v] = 0;
+            long long m = min(W_unit[v], W_unit[-v]);
+            if (m > 0) {
+                changeUnit(v, -m);
+                changeUnit(-v, -m);
+                saveAddition(cost[n_assigned], (ULL)m);
+                saveAddition(lb, (ULL)m);
+            }
+            R_unit[v] = W_unit[v];
+            R_unit[-v] = W_unit[-v];
+        }
+        // every inconsistent subformula found by unit propagation adds the
+        // minimum weight of its clauses
+        bool chain;
+        while (lb < needed && detectConflict(chain))
+            saveAddition(lb, (ULL)resolveConflict(chain));
+        for (size_t i = 0; i < touched.size(); ++i)
+            residual[touched[i]] = weight[touched[i]];
+        touched.clear();
+        return lb;
+    }
+
+   public:
+    //! QuboFormula constructor
+    /*! \param inst the clause arrays of the formula, no clause may contain
+     *  more than two literals
+     *  \param ctx output sink and random number generator of the instance
+     */
+    QuboFormula(const WcnfInstance &inst,
+                const SolverContext &ctx = SolverContext())
+        : ctx(ctx) {
+        initialize(inst);
+    }
+    //! build the formula from the clauses of another instance, reusing the
+    //! memory of its arrays; used to solve many small formulas in a row
+    void reset(const WcnfInstance &inst) { initialize(inst); }
+    //! get the output sink and random number generator of the instance
+    inline SolverContext &context() { return ctx; }
+    //! get the weight of clauses containing i used in inconsistent subformulas
+    inline long long getW_lb(int i) const { return W_lb[i]; }
+    //! get number of variables
+    inline int getNVars() const { return nVars; }
+    //! get the type of the instance
+    inline bool isWeighted() const { return isWcnf; }
+    //! get the weight of the clauses of literal L
+    inline long long getLength(int L) const {
+        assert(!assigned_values[abs(L)]);
+        return W_unit[L] + W_binary[L];
+    }
+    //! get the weight of the unit clauses of literal L
+    inline long long getUnitLength(int L) const { return W_unit[L]; }
+    //! get the weight of the binary clauses of literal L
+    inline long long getBinaryLength(int L) const { return W_binary[L]; }
+
+    //! assign literal L the value true
+    /*! \param L literal to be assigned
+     *  \returns true iff assignment does not lead to costs >= bestCost
+     */
+    inline bool assignLiteral(int L) {
+        assert(-nVars <= L && L <= nVars && L != 0 &&
+               assigned_values[abs(L)] == 0);
+        if (cost[n_assigned] + (ULL)W_unit[-L] >= bestCost) return false;
+        cost[n_assigned + 1] = cost[n_assigned] + (ULL)W_unit[-L];
+        int v = abs(L);
+        assigned_values[v] = L > 0 ? 1 : -1;
+        assigned_literals[n_assigned++] = L;
+        trailMark[n_assigned] =
+            make_pair((int)clauseTrail.size(), (int)unitTrail.size());
+        int last = freeVars.back();
+        freeVars[freePos[v]] = last;
+        freePos[last] = freePos[v];
+        freeVars.pop_back();
+        const int *end = &adj[0] + adjStart[v + 1];
+        for (const int *k = &adj[0] + adjStart[v]; k != end; k += 3) {
+            int u = k[0];
+            // the mask excludes clauses whose other variable is assigned
+            long long mask = -(long long)(assigned_values[u] == 0);
+            // the clauses (-L, u) and (-L, -u) become unit clauses, the
+            // clauses (L, u) and (L, -u) are fulfilled
+            long long pos = weight[clauseOf(k, -L, u)] & mask;
+            long long neg = weight[clauseOf(k, -L, -u)] & mask;
+            W_unit[u] += pos;
+            W_unit[-u] += neg;
+            W_binary[u] -= pos + (weight[clauseOf(k, L, u)] & mask);
+            W_binary[-u] -= neg + (weight[clauseOf(k, L, -u)] & mask);
+        }
+        // is it a complete assignment?
+        if (n_assigned == nVars) {
+            bestA = assigned_values;
+            bestCost = solutionCost = cost[n_assigned];
+            ctx.print("o %llu\n", bestCost);
+            ctx.flush();
+        }
+        return true;
+    }
+    //! unassign the literal assigned last
+    void unassignLiteral() {
+        assert(n_assigned > 0);
+        undoChanges();
+        int L = assigned_literals[--n_assigned];
+        int v = abs(L);
+        const int *end = &adj[0] + adjStart[v + 1];
+        for (const int *k = &adj[0] + adjStart[v]; k != end; k += 3) {
+            int u = k[0];
+            long long mask = -(long long)(assigned_values[u] == 0);
+            long long pos = weight[clauseOf(k, -L, u)] & mask;
+            long long neg = weight[clauseOf(k, -L, -u)] & mask;
+            W_unit[u] -= pos;
+            W_unit[-u] -= neg;
+            W_binary[u] += pos + (weight[clauseOf(k, L, u)] & mask);
+            W_binary[-u] += neg + (weight[clauseOf(k, L, -u)] & mask);
+        }
+        assigned_values[v] = 0;
+        freePos[v] = (int)freeVars.size();
+        freeVars.push_back(v);
+    }
+    //! compute lower bound
+    /*! \returns bestCost minus the cost of the current partial assignment
+     * and the lower bound of the remaining formula, 0 if this is not positive
+     */
+    ULL bestMinusLowerBound() {
+        assert(n_assigned < nVars);
+        ULL needed =
+            cost[n_assigned] < bestCost ? bestCost - cost[n_assigned] : 0;
+        if (!needed) {
+            // no assignment is better than the best one
+            if (n_assigned == 0) raiseLowerBound(bestCost);
+            return 0;
+        }
+        ULL lb = computeLowerBound(needed);
+        ULL ret = lb < needed ? needed - lb : 0;
+        if (n_assigned == 0) {
+            ctx.print("c first lower bound: %llu\n", bestCost - ret);
+            raiseLowerBound(bestCost - ret);
+        }
+        return ret;
+    }
+
+    //! get the best assignment found in the original variable numbering
+    /*! \returns a vector whose entry i-1 is 1 if variable i is true and -1
+     * otherwise; variables which do not occur in the formula are true
+     */
+    inline vector<int> getSolution() const {
+        vector<int> solution(maxVn, 1);
+        for (int i = 1; i <= maxVn; ++i)
+            if (maps_to[i] > 0) solution[i - 1] = (int)bestA[maps_to[i]];
+        return solution;
+    }
+    //! get the value of variable i in the best assignment found
+    /*! \returns 1 if it is true, -1 if it is false and 0 if no assignment
+     * has been found yet
+     */
+    inline int getBestValue(int i) const {
+        return solutionCost < hard ? bestA[i] : 0;
+    }
+    //! print the optimal solution in the maxsat evaluation format
+    inline void printSolution() const {
+        if (solutionCost == hard) {
+            ctx.print("s UNSATISFIABLE\n");
+            return;
+        }
+        ctx.print("s OPTIMUM FOUND\n");
+        ctx.print("c Optimal Solution = %llu\nv", solutionCost);
+        for (int i = 1; i <= maxVn; ++i)
+            ctx.print(" %d", maps_to[i] < 0 ? i : (int)bestA[maps_to[i]] * i);
+        ctx.print("\n");
+        ctx.flush();
+    }
+    inline ULL getHardWeight() const { return hard; }
+    //! return the best cost of a complete assignment found so far
+    inline ULL getBestCost() const { return bestCost; }
+    //! return the cost of the assignment returned by getSolution
+    inline ULL getSolutionCost() const { return solutionCost; }
+    //! lower the upper bound to the cost of an assignment found elsewhere
+    /*! \param ub the new upper bound; ignored if not below bestCost
+     */
+    inline void setUpperBound(ULL ub) {
+        if (ub < bestCost) bestCost = ub;
+    }
+    //! get the lower bound computed at the root of the search
+    inline ULL getLowerBound() const { return lowerBound; }
+    //! raise the lower bound to a bound proven elsewhere
+    inline void raiseLowerBound(ULL lb) {
+        if (lb > lowerBound) lowerBound = lb;
+    }
+    //! get the i-th assigned literal, in the order of assignment
+    inline int getAssignedLiteral(int i) const {
+        assert(i >= 0 && i < n_assigned);
+        return assigned_literals[i];
+    }
+    //! initialize the best assignment to the assignment of besta
+    inline void saveBest(ULL best, const char *besta) {
+        assert(best <= bestCost);
+        bestCost = solutionCost = best;
+        for (int i = 1; i <= maxVn; ++i)
+            if (maps_to[i] > 0) bestA[maps_to[i]] = besta[i];
+    }
+    //! initialize the best assignment to an assignment found elsewhere
+    /*! \param start the assignment in the original variable numbering
+     *  \returns false iff start is not cheaper than the best assignment
+     */
+    inline bool saveBest(const Assignment &start) {
+        if (start.cost >= bestCost) return false;
+        saveBest(start.cost, start.values.data());
+        return true;
+    }
+};
+
+#endif
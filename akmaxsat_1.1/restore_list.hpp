@@ -89,7 +89,7 @@ class restore_list {
         assert(added == 0);
         if (pos == data) return NULL;
         assert(pos >= data + 5);
-        deletion_time = *((ULL *)(pos - 2));
+        memcpy(&deletion_time, pos - 2, sizeof(deletion_time));
         if (deletion_time > timestamp) {
             length = *(pos - 3);
             if (length & (1 << 30)) {
@@ -97,7 +97,7 @@ class restore_list {
                 sign = true;
             } else
                 sign = false;
-            weight = *((ULL *)(pos - 5));
+            memcpy(&weight, pos - 5, sizeof(weight));
             pos -= (5 + length);
             return pos;
         }
@@ -111,12 +111,14 @@ class restore_list {
     void commit(long long timestamp, ULL weight, bool sign) {
         assert(added > 0);
         if (pos + 5 > end) increase_data();
-        *((ULL *)pos) = weight;
+        // the 64-bit numbers take two ints each and need not be aligned for
+        // their type, so that they are copied bytewise
+        memcpy(pos, &weight, sizeof(weight));
         pos += 2;
         if (sign) added |= 1 << 30;
         *pos++ = added;
         added = 0;
-        *((ULL *)pos) = timestamp;
+        memcpy(pos, &timestamp, sizeof(timestamp));
         pos += 2;
     }
 };
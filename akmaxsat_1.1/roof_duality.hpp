@@ -0,0 +1,262 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ROOF_DUALITY_HPP_INCLUDE
+#define ROOF_DUALITY_HPP_INCLUDE
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "wcnf_instance.hpp"
+
+using namespace std;
+
+/*! \file roof_duality.hpp Documentation of class ImplicationNetwork
+ */
+//! ImplicationNetwork is the flow network of a formula without clauses of
+//! more than two literals, in which a clause with weight w violated iff the
+//! literals u and v are false gives the arcs -u -> v and -v -> u of
+//! capacity w; a unit clause u gives the arcs x0 -> u and -u -> -x0. The
+//! maximum flow from x0 to -x0 is twice the roof dual bound, and the literals
+//! reachable from x0 in the residual network of the symmetrized flow can be
+//! set to true without losing all optimal assignments
+class ImplicationNetwork {
+    //! arc of the network; arc e ^ 1 is the reverse arc of arc e, and arc
+    //! e ^ 2 is the arc of the other literals of the same clause
+    struct Arc {
+        int to;
+        //! residual capacity
+        ULL cap;
+    };
+    //! number of variables
+    int nVars;
+    //! arcs, four per clause
+    vector<Arc> arcs;
+    //! capacity of each arc before the flow was sent
+    vector<ULL> capacity;
+    //! arcs leaving each node
+    vector<vector<int> > out;
+    //! distance of each node from the source in the level graph
+    vector<int> level;
+    //! next arc of each node to be tried by the search for a blocking flow
+    vector<int> next;
+
+    //! node of literal L; node 0 is the source x0 and node 1 the sink -x0
+    static inline int node(int L) { return 2 * abs(L) + (L < 0); }
+    //! add the arc from node a to node b and its reverse arc
+    void addArc(int a, int b, ULL w) {
+        Arc e = {b, w}, r = {a, 0};
+        out[a].push_back((int)arcs.size());
+        arcs.push_back(e);
+        capacity.push_back(w);
+        out[b].push_back((int)arcs.size());
+        arcs.push_back(r);
+        capacity.push_back(0);
+    }
+    //! compute the distances from the source in the residual network
+    /*! \returns true iff the sink can be reached
+     */
+    bool buildLevels() {
+        fill(level.begin(), level.end(), -1);
+        vector<int> queue(1, 0);
+        level[0] = 0;
+        for (size_t h = 0; h < queue.size(); ++h) {
+            int a = queue[h];
+            for (size_t k = 0; k < out[a].size(); ++k) {
+                const Arc &e = arcs[out[a][k]];
+                if (e.cap > 0 && level[e.to] < 0) {
+                    level[e.to] = level[a] + 1;
+                    queue.push_back(e.to);
+                }
+            }
+        }
+        return level[1] >= 0;
+    }
+    //! send a blocking flow along the level graph
+    /*! \returns the amount of flow sent
+     */
+    ULL blockingFlow() {
+        fill(next.begin(), next.end(), 0);
+        ULL total = 0;
+        // arcs of the current path from the source
+        vector<int> path;
+        int a = 0;
+        while (true) {
+            if (a == 1) {
+                ULL f = arcs[path[0]].cap;
+                for (size_t k = 1; k < path.size(); ++k)
+                    f = min(f, arcs[path[k]].cap);
+                for (size_t k = 0; k < path.size(); ++k) {
+                    arcs[path[k]].cap -= f;
+                    arcs[path[k] ^ 1].cap += f;
+                }
+                total += f;
+                // continue from the tail of the first saturated arc
+                size_t k = 0;
+                while (arcs[path[k]].cap > 0) ++k;
+                path.resize(k);
+                a = k ? arcs[path[k - 1]].to : 0;
+                continue;
+            }
+            bool advanced = false;
+            for (; next[a] < (int)out[a].size(); ++next[a]) {
+                const Arc &e = arcs[out[a][next[a]]];
+                if (e.cap > 0 && level[e.to] == level[a] + 1) {
+                    path.push_back(out[a][next[a]]);
+                    a = e.to;
+                    advanced = true;
+                    break;
+                }
+            }
+            if (advanced) continue;
+            // no path to the sink leads through a
+            if (a == 0) break;
+            level[a] = -1;
+            int e = path.back();
+            path.pop_back();
+            a = arcs[e ^ 1].to;
+        }
+        return total;
+    }
+    //! flow sent along arc e and along the arc of the other literals
+    inline ULL symmetricFlow(int e) const {
+        return capacity[e] - arcs[e].cap + capacity[e ^ 2] - arcs[e ^ 2].cap;
+    }
+
+   public:
+    //! build the network of inst
+    /*! \param inst formula without clauses of more than two literals; the
+     *  sum of its weights must be less than 2^62
+     */
+    explicit ImplicationNetwork(const WcnfInstance &inst)
+        : nVars(inst.maxVn),
+          out(2 * inst.maxVn + 2),
+          level(2 * inst.maxVn + 2),
+          next(2 * inst.maxVn + 2) {
+        vector<int_c>::const_iterator lit = inst.literals.begin();
+        for (int i = 0; i < inst.nClauses(); ++i) {
+            int len = inst.lengths[i];
+            assert(len <= 2);
+            ULL w = inst.weights[i];
+            int u = len > 0 ? lit[0] : 0, v = len > 1 ? lit[1] : u;
+            lit += len;
+            // clauses without literals do not depend on the assignment
+            if (len == 0 || u == -v) continue;
+            if (u == v) {
+                addArc(0, node(u), w);
+                addArc(node(-u), 1, w);
+            } else {
+                addArc(node(-u), node(v), w);
+                addArc(node(-v), node(u), w);
+            }
+        }
+    }
+
+    //! compute a maximum flow from x0 to -x0
+    /*! \returns the value of the flow
+     */
+    ULL maxFlow() {
+        ULL flow = 0;
+        while (buildLevels()) flow += blockingFlow();
+        return flow;
+    }
+    //! find the literals which can be fixed after maxFlow
+    /*! \param fixed receives at index i 1 if variable i can be set to true,
+     *  -1 if it can be set to false and 0 otherwise
+     */
+    void persistencies(vector<char> &fixed) const {
+        vector<char> reached(out.size(), 0);
+        vector<int> queue(1, 0);
+        reached[0] = 1;
+        for (size_t h = 0; h < queue.size(); ++h) {
+            int a = queue[h];
+            for (size_t k = 0; k < out[a].size(); ++k) {
+                int e = out[a][k];
+                // a forward arc is usable unless it and the arc of the other
+                // literals are saturated, a reverse arc if either carries flow
+                bool usable = e & 1 ? symmetricFlow(e ^ 1) > 0
+                                    : symmetricFlow(e) < 2 * capacity[e];
+                if (usable && !reached[arcs[e].to]) {
+                    reached[arcs[e].to] = 1;
+                    queue.push_back(arcs[e].to);
+                }
+            }
+        }
+        fixed.assign(nVars + 1, 0);
+        for (int v = 1; v <= nVars; ++v) {
+            assert(!reached[node(v)] || !reached[node(-v)]);
+            if (reached[node(v)]) fixed[v] = 1;
+            if (reached[node(-v)]) fixed[v] = -1;
+        }
+    }
+};
+
+//! fix variables of a formula without clauses of more than two literals by
+//! roof duality
+/*! \param inst the formula; the sum of its weights must be less than 2^62
+ *  \param reduced receives inst with the fixed variables substituted; the
+ *  variables keep their numbers, and the clauses decided by the fixed
+ *  variables are left out
+ *  \param fixed receives at index i 1 if variable i was fixed to true, -1
+ *  if it was fixed to false and 0 otherwise; some optimal assignment of
+ *  inst extends the fixed values
+ *  \param constant receives the weight of the clauses violated by the
+ *  fixed values
+ *  \returns the roof dual lower bound of the cost of inst
+ */
+inline ULL roofDuality(const WcnfInstance &inst, WcnfInstance &reduced,
+                       vector<char> &fixed, ULL &constant) {
+    ImplicationNetwork network(inst);
+    ULL flow = network.maxFlow();
+    network.persistencies(fixed);
+    reduced = WcnfInstance();
+    reduced.hard = inst.hard;
+    reduced.weighted = inst.weighted;
+    constant = 0;
+    ULL empty = 0;
+    vector<int_c> clause;
+    vector<int_c>::const_iterator lit = inst.literals.begin();
+    for (int i = 0; i < inst.nClauses(); ++i) {
+        bool satisfied = false;
+        clause.clear();
+        for (int j = 0; j < inst.lengths[i]; ++j) {
+            int L = lit[j], value = fixed[abs(L)];
+            if (value == 0)
+                clause.push_back(L);
+            else if ((L > 0) == (value > 0))
+                satisfied = true;
+        }
+        lit += inst.lengths[i];
+        if (inst.lengths[i] == 0)
+            empty += inst.weights[i];
+        else if (satisfied)
+            continue;
+        if (clause.empty())
+            constant += inst.weights[i];
+        else
+            reduced.addClause(clause.data(), (int)clause.size(),
+                              inst.weights[i]);
+    }
+    reduced.maxVn = inst.maxVn;
+    return empty + (flow + 1) / 2;
+}
+
+#endif
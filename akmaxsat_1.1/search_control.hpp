@@ -0,0 +1,138 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SEARCH_CONTROL_HPP_INCLUDE
+#define SEARCH_CONTROL_HPP_INCLUDE
+
+#include <stddef.h>
+
+#include <atomic>
+#include <chrono>
+
+#include "clauses.hpp"
+
+using namespace std;
+
+/*! \file search_control.hpp Documentation of classes SharedBound and
+ * SearchControl
+ */
+//! SharedBound holds the cost of the best assignment found by any of several
+//! searches running concurrently on the same formula
+class SharedBound {
+    //! minimum over all published costs
+    atomic<ULL> cost;
+
+   public:
+    SharedBound() : cost(MAXWEIGHT) {}
+
+    //! publish the best cost of a search and get the best cost of all
+    /*! \param c the cost of the best assignment found by the search
+     *  \returns the minimum over all published costs
+     */
+    inline ULL share(ULL c) {
+        ULL best = cost.load(memory_order_relaxed);
+        while (c < best &&
+               !cost.compare_exchange_weak(best, c, memory_order_relaxed))
+            ;
+        return c < best ? c : best;
+    }
+    //! get the minimum over all published costs
+    inline ULL get() const { return cost.load(memory_order_relaxed); }
+};
+
+//! SearchControl decides when a running search has to be stopped early; it
+//! is polled by the search once every POLL_INTERVAL nodes so that the
+//! checks stay off the hot path. Besides cancellation it enforces budgets:
+//! a search stopped by a budget still holds the best assignment found
+class SearchControl {
+   public:
+    //! number of search nodes between two polls (a power of 2)
+    const static long long POLL_INTERVAL = 1 << 8;
+
+    //! flag which can be set from any thread to cancel the search
+    const atomic<bool> *cancel_flag;
+    //! optional check invoked at each poll, returns true to stop the search
+    bool (*check)(void *);
+    //! argument passed to check
+    void *check_data;
+    //! optional upper bound exchanged with concurrent searches at every node
+    SharedBound *incumbent;
+    //! optional counter to which concurrent searches add their nodes
+    atomic<long long> *node_count;
+    //! stop after this many nodes (rounded up to POLL_INTERVAL), 0 for none
+    long long node_limit;
+    //! stop at this point of time
+    chrono::steady_clock::time_point deadline;
+    //! stop as soon as an assignment cheaper than this has been found, 0 for
+    //! no target
+    ULL target_cost;
+    //! set when the search was stopped before it completed
+    bool interrupted;
+    //! set when the search was stopped by node_limit, deadline or
+    //! target_cost rather than cancelled
+    bool limit_reached;
+
+    SearchControl()
+        : cancel_flag(NULL),
+          check(NULL),
+          check_data(NULL),
+          incumbent(NULL),
+          node_count(NULL),
+          node_limit(0),
+          deadline(chrono::steady_clock::time_point::max()),
+          target_cost(0),
+          interrupted(false),
+          limit_reached(false) {}
+
+    //! stop the search after the given number of seconds
+    void setTimeLimit(double seconds) {
+        deadline = chrono::steady_clock::now() +
+                   chrono::duration_cast<chrono::steady_clock::duration>(
+                       chrono::duration<double>(seconds));
+    }
+
+    //! called by the search once per node, starting with node 0
+    /*! \param nodes the number of nodes explored so far
+     *  \param best the cost of the best assignment found so far
+     *  \returns true iff the search has to stop
+     */
+    inline bool poll(long long nodes, ULL best = MAXWEIGHT) {
+        if (nodes & (POLL_INTERVAL - 1)) return false;
+        if (node_count != NULL && nodes > 0)
+            node_count->fetch_add(POLL_INTERVAL, memory_order_relaxed);
+        return test(nodes, best);
+    }
+    //! check all conditions for stopping the search
+    /*! \param nodes the number of nodes explored so far
+     *  \param best the cost of the best assignment found so far
+     *  \returns true iff the search has to stop
+     */
+    bool test(long long nodes, ULL best) {
+        if ((cancel_flag != NULL && cancel_flag->load(memory_order_relaxed)) ||
+            (check != NULL && check(check_data)))
+            interrupted = true;
+        else if ((node_limit > 0 && nodes >= node_limit) ||
+                 best < target_cost ||
+                 (deadline != chrono::steady_clock::time_point::max() &&
+                  chrono::steady_clock::now() >= deadline))
+            interrupted = limit_reached = true;
+        return interrupted;
+    }
+};
+
+#endif
@@ -0,0 +1,92 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOLVER_CONFIG_HPP_INCLUDE
+#define SOLVER_CONFIG_HPP_INCLUDE
+
+/*! \file solver_config.hpp Documentation of struct SolverConfig
+ */
+//! SolverConfig selects the optional parts of the solver at compile time;
+//! CNF_Formula and the search functions take it as template parameter, so
+//! that disabled parts cost nothing in the generated code
+template <bool Fuip, bool CalcMh, bool BestFirst, bool PropList, bool UseGup,
+          bool Stats>
+struct SolverConfig {
+    //! shorten the implication lists to the first unique implication point
+    const static bool fuip = Fuip;
+    //! improve the lower bound with the height transformation (max-sum
+    //! diffusion) after generalized unit propagation
+    const static bool calcMh = CalcMh;
+    //! recursive best-first search (rbfs) instead of depth-first search
+    //! (fast_backtrack); changes the meaning of bestMinusLowerBound
+    const static bool bestFirst = BestFirst;
+    //! keep a stack of literals which can be propagated because of hard
+    //! unit clauses (used by rbfs only)
+    const static bool propList = PropList;
+    //! look for inconsistent subformulas beyond failed literals
+    const static bool useGup = UseGup;
+    //! count the nodes explored on each level of the search
+    const static bool stats = Stats;
+};
+
+// the configuration selected by the preprocessor switches of the build
+#ifdef FUIP
+#define AKMAXSAT_FUIP true
+#else
+#define AKMAXSAT_FUIP false
+#endif
+#ifdef CALC_MH
+#define AKMAXSAT_CALC_MH true
+#else
+#define AKMAXSAT_CALC_MH false
+#endif
+#ifdef RBFS
+#define AKMAXSAT_RBFS true
+#else
+#define AKMAXSAT_RBFS false
+#endif
+#ifdef PROP_LIST
+#define AKMAXSAT_PROP_LIST true
+#else
+#define AKMAXSAT_PROP_LIST false
+#endif
+#ifdef NO_GUP
+#define AKMAXSAT_GUP false
+#else
+#define AKMAXSAT_GUP true
+#endif
+#ifdef STATS
+#define AKMAXSAT_STATS true
+#else
+#define AKMAXSAT_STATS false
+#endif
+
+//! configuration selected by the preprocessor switches FUIP, CALC_MH, RBFS,
+//! PROP_LIST, NO_GUP and STATS
+typedef SolverConfig<AKMAXSAT_FUIP, AKMAXSAT_CALC_MH, AKMAXSAT_RBFS,
+                     AKMAXSAT_PROP_LIST, AKMAXSAT_GUP, AKMAXSAT_STATS>
+    DefaultConfig;
+
+#undef AKMAXSAT_FUIP
+#undef AKMAXSAT_CALC_MH
+#undef AKMAXSAT_RBFS
+#undef AKMAXSAT_PROP_LIST
+#undef AKMAXSAT_GUP
+#undef AKMAXSAT_STATS
+
+#endif
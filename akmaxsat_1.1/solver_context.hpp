@@ -0,0 +1,71 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOLVER_CONTEXT_HPP_INCLUDE
+#define SOLVER_CONTEXT_HPP_INCLUDE
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <random>
+
+using namespace std;
+
+/*! \file solver_context.hpp Documentation of class SolverContext
+ */
+//! SolverContext holds everything a solver instance would otherwise take
+//! from process-wide state: the sink for its log and solution output and its
+//! random number generator
+class SolverContext {
+    //! output sink, NULL if the solver should be silent
+    FILE *out;
+
+   public:
+    //! random number generator of the solver instance
+    mt19937_64 rng;
+
+    //! SolverContext constructor
+    /*! \param out the output sink, NULL suppresses all output
+     *  \param seed the seed of the random number generator
+     */
+    explicit SolverContext(FILE *out = NULL, unsigned long long seed = 0)
+        : out(out), rng(seed) {}
+
+    //! derive the context of a helper search
+    /*! \returns a context with the same output sink and a seed drawn from
+     *  rng
+     */
+    inline SolverContext fork() { return SolverContext(out, rng()); }
+
+    //! check if output is enabled
+    inline bool verbose() const { return out != NULL; }
+    //! printf to the output sink
+    inline void print(const char *format, ...) const {
+        if (out == NULL) return;
+        va_list args;
+        va_start(args, format);
+        vfprintf(out, format, args);
+        va_end(args);
+    }
+    //! flush the output sink
+    inline void flush() const {
+        if (out != NULL) fflush(out);
+    }
+};
+
+#endif
@@ -0,0 +1,214 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WCNF_INSTANCE_HPP_INCLUDE
+#define WCNF_INSTANCE_HPP_INCLUDE
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "clauses.hpp"
+
+using namespace std;
+
+/*! \file wcnf_instance.hpp Documentation of structs WcnfInstance and Assignment
+ */
+//! WcnfInstance stores a (weighted) CNF formula as flat clause arrays in the
+//! original variable numbering; it is the input of the CNF_Formula constructor
+struct WcnfInstance {
+    //! maximum variable index occurring in the formula
+    int maxVn;
+    //! weight of hard clauses, 0 if there are none
+    ULL hard;
+    //! true if the clauses carry individual weights
+    bool weighted;
+    //! number of literals of each clause
+    vector<int> lengths;
+    //! literals of all clauses, one clause after another
+    vector<int_c> literals;
+    //! weight of each clause
+    vector<ULL> weights;
+
+    WcnfInstance() : maxVn(0), hard(0), weighted(true) {}
+
+    //! number of clauses
+    inline int nClauses() const { return (int)lengths.size(); }
+    //! remove all clauses, keeping the memory of the arrays for reuse
+    void clear() {
+        maxVn = 0;
+        hard = 0;
+        weighted = true;
+        lengths.clear();
+        literals.clear();
+        weights.clear();
+    }
+    //! append a clause
+    /*! \param lits the literals of the clause
+     *  \param len the number of literals
+     *  \param weight the weight of the clause
+     */
+    inline void addClause(const int_c *lits, int len, ULL weight) {
+        assert(len >= 0 && weight > 0);
+        for (int i = 0; i < len; ++i) {
+            assert(lits[i] != 0);
+            if (abs(lits[i]) > maxVn) maxVn = abs(lits[i]);
+        }
+        literals.insert(literals.end(), lits, lits + len);
+        lengths.push_back(len);
+        weights.push_back(weight);
+    }
+};
+
+//! Assignment stores a complete assignment of the variables of a
+//! WcnfInstance together with its cost
+struct Assignment {
+    //! value of variable i at index i: 1 if it is true, -1 otherwise
+    vector<char> values;
+    //! sum of the weights of the clauses violated by values
+    ULL cost;
+
+    Assignment() : cost(MAXWEIGHT) {}
+};
+
+//! compute the cost of an assignment
+/*! \param inst the formula
+ *  \param values value of variable i at index i, 1 for true and -1 for
+ *  false
+ *  \returns the sum of the weights of the violated clauses, at most
+ *  MAXWEIGHT
+ */
+inline ULL evaluate(const WcnfInstance &inst, const vector<char> &values) {
+    assert((int)values.size() > inst.maxVn);
+    ULL cost = 0;
+    vector<int_c>::const_iterator lit = inst.literals.begin();
+    for (int i = 0; i < inst.nClauses(); ++i) {
+        bool sat = false;
+        for (int j = 0; j < inst.lengths[i]; ++j, ++lit)
+            if ((*lit > 0) == (values[abs(*lit)] > 0)) sat = true;
+        if (!sat) cost += min(inst.weights[i], MAXWEIGHT - cost);
+    }
+    return cost;
+}
+
+//! split a formula into parts which share no variables
+/*! \param inst the formula
+ *  \param parts receives one formula per connected component of the
+ *  variables linked by the clauses, ordered by the number of clauses;
+ *  clauses without literals are added to the first part
+ *  \param vars receives for each part the variable of inst which variable
+ *  i of the part represents at index i - 1
+ *  \returns the number of parts; variables which occur in no clause do not
+ *  belong to any part
+ */
+inline int splitComponents(const WcnfInstance &inst,
+                           vector<WcnfInstance> &parts,
+                           vector<vector<int> > &vars) {
+    // union find over the variables, with path halving
+    vector<int> parent(inst.maxVn + 1);
+    for (int v = 0; v <= inst.maxVn; ++v) parent[v] = v;
+    vector<char> occurs(inst.maxVn + 1, 0);
+    vector<int_c>::const_iterator lit = inst.literals.begin();
+    for (int i = 0; i < inst.nClauses(); ++i) {
+        for (int j = 0; j < inst.lengths[i]; ++j) {
+            int a = abs(lit[0]), b = abs(lit[j]);
+            occurs[b] = 1;
+            while (parent[a] != a) a = parent[a] = parent[parent[a]];
+            while (parent[b] != b) b = parent[b] = parent[parent[b]];
+            parent[max(a, b)] = min(a, b);
+        }
+        lit += inst.lengths[i];
+    }
+    // number the components by their smallest variable
+    vector<int> part(inst.maxVn + 1, -1), index(inst.maxVn + 1, 0);
+    vector<int> sizes;
+    int n = 0;
+    for (int v = 1; v <= inst.maxVn; ++v) {
+        if (!occurs[v]) continue;
+        int r = v;
+        while (parent[r] != r) r = parent[r];
+        if (part[r] < 0) {
+            part[r] = n++;
+            sizes.push_back(0);
+        }
+        part[v] = part[r];
+        index[v] = ++sizes[part[v]];
+    }
+    vector<int> nClauses(n, 0);
+    lit = inst.literals.begin();
+    for (int i = 0; i < inst.nClauses(); ++i) {
+        if (inst.lengths[i] > 0) ++nClauses[part[abs(*lit)]];
+        lit += inst.lengths[i];
+    }
+    // order the parts by their number of clauses
+    vector<pair<int, int> > sorted(n);
+    for (int k = 0; k < n; ++k) sorted[k] = make_pair(nClauses[k], k);
+    sort(sorted.begin(), sorted.end());
+    vector<int> order(n), rank(n);
+    for (int k = 0; k < n; ++k) {
+        order[k] = sorted[k].second;
+        rank[order[k]] = k;
+    }
+    parts.assign(n, WcnfInstance());
+    vars.assign(n, vector<int>());
+    for (int k = 0; k < n; ++k) {
+        parts[k].hard = inst.hard;
+        parts[k].weighted = inst.weighted;
+        parts[k].maxVn = sizes[order[k]];
+        parts[k].lengths.reserve(nClauses[order[k]]);
+        parts[k].weights.reserve(nClauses[order[k]]);
+        vars[k].resize(sizes[order[k]]);
+    }
+    for (int v = 1; v <= inst.maxVn; ++v)
+        if (occurs[v]) vars[rank[part[v]]][index[v] - 1] = v;
+    vector<int_c> clause;
+    lit = inst.literals.begin();
+    for (int i = 0; i < inst.nClauses() && n > 0; ++i) {
+        clause.clear();
+        for (int j = 0; j < inst.lengths[i]; ++j)
+            clause.push_back(lit[j] > 0 ? index[lit[j]] : -index[-lit[j]]);
+        int k = inst.lengths[i] > 0 ? rank[part[abs(*lit)]] : 0;
+        parts[k].addClause(clause.data(), inst.lengths[i], inst.weights[i]);
+        lit += inst.lengths[i];
+    }
+    return n;
+}
+
+//! write a formula in DIMACS wcnf format
+/*! \param ostr the output stream
+ *  \param inst the formula to be written
+ */
+inline void writeDimacs(ostream &ostr, const WcnfInstance &inst) {
+    ostr << "p wcnf " << inst.maxVn << " " << inst.nClauses();
+    if (inst.hard) ostr << " " << inst.hard;
+    ostr << "\n";
+    vector<int_c>::const_iterator lit = inst.literals.begin();
+    for (int i = 0; i < inst.nClauses(); ++i) {
+        ostr << inst.weights[i];
+        for (int j = 0; j < inst.lengths[i]; ++j) ostr << " " << *lit++;
+        ostr << " 0\n";
+    }
+}
+
+#endif
@@ -0,0 +1,133 @@
+/*
+   <akmaxsat: a (partial) (weighted) MAX-SAT solver>
+    Copyright (C) 2010 Adrian Kuegel
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef WORK_POOL_HPP_INCLUDE
+#define WORK_POOL_HPP_INCLUDE
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+/*! \file work_pool.hpp Documentation of class WorkPool
+ */
+//! WorkPool distributes the search tree among the workers of a parallel
+//! branch and bound; a work item is an open subtree identified by the
+//! literals assigned on the path from the root to it. Busy workers hand
+//! over branches while some worker is idle
+class WorkPool {
+    //! protects items, waiting and done
+    mutex m;
+    //! signalled when an item was added or the search has ended
+    condition_variable cv;
+    //! signalled when the search has ended
+    condition_variable finished;
+    //! subtrees which have not been explored yet
+    deque<vector<int> > items;
+    //! number of workers
+    int nworkers;
+    //! number of workers waiting for an item
+    int waiting;
+    //! set when all workers are idle and no item is left, or on stop
+    bool done;
+    //! true iff there are more waiting workers than items
+    atomic<bool> hungry;
+    //! set when the search has to be stopped early
+    atomic<bool> stopped;
+
+   public:
+    //! WorkPool constructor
+    /*! \param nworkers number of workers taking items from the pool; the
+     *  pool initially holds the whole search tree as its only item
+     */
+    explicit WorkPool(int nworkers)
+        : nworkers(nworkers),
+          waiting(0),
+          done(false),
+          hungry(false),
+          stopped(false) {
+        items.push_back(vector<int>());
+    }
+
+    //! get the next subtree to be explored, blocks until one is available
+    /*! \param prefix receives the literals leading to the subtree
+     *  \returns false iff the search has ended
+     */
+    bool take(vector<int> &prefix) {
+        unique_lock<mutex> lock(m);
+        ++waiting;
+        while (items.empty() && !done) {
+            // nobody is left who could hand over work
+            if (waiting == nworkers) {
+                done = true;
+                cv.notify_all();
+                finished.notify_all();
+                break;
+            }
+            hungry.store(true, memory_order_relaxed);
+            cv.wait(lock);
+        }
+        --waiting;
+        if (done) return false;
+        prefix.swap(items.front());
+        items.pop_front();
+        hungry.store(waiting > (int)items.size(), memory_order_relaxed);
+        return true;
+    }
+    //! hand over a subtree to the waiting workers
+    /*! \param prefix the literals leading to the subtree, cleared
+     */
+    void give(vector<int> &prefix) {
+        lock_guard<mutex> lock(m);
+        items.push_back(vector<int>());
+        items.back().swap(prefix);
+        hungry.store(waiting > (int)items.size(), memory_order_relaxed);
+        cv.notify_one();
+    }
+    //! check if a worker is waiting for an item; polled once per node
+    inline bool wantsWork() const {
+        return hungry.load(memory_order_relaxed);
+    }
+
+    //! stop the search; workers return after their next poll
+    void stop() {
+        stopped.store(true, memory_order_relaxed);
+        lock_guard<mutex> lock(m);
+        done = true;
+        cv.notify_all();
+        finished.notify_all();
+    }
+    //! flag set by stop, to be used as cancel flag of the workers
+    inline const atomic<bool> *stopFlag() const { return &stopped; }
+
+    //! wait until the search has ended
+    /*! \param ms maximum waiting time in milliseconds
+     *  \returns true iff the search has ended
+     */
+    bool wait(int ms) {
+        unique_lock<mutex> lock(m);
+        if (!done) finished.wait_for(lock, chrono::milliseconds(ms));
+        return done;
+    }
+};
+
+#endif
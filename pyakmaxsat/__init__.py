@@ -1,4 +1,6 @@
 import cxxakmaxsat
-from cxxakmaxsat import solve_qubo
+from cxxakmaxsat import (CancelToken, solve_qubo, solve_bqm, solve_qubo_csr,
+                         solve_batch, supported_compressions)
 
-from .core import AKMaxSATSolver, AKMaxSATSampler, save_wcnf
+from .core import (AKMaxSATSolver, AKMaxSATSampler, save_wcnf, save_binary,
+                   wcnf_to_binary)
@@ -4,7 +4,8 @@ import tempfile
 import numpy as np
 import dimod
 
-from cxxakmaxsat import solve_qubo
+from cxxakmaxsat import (solve_qubo, solve_bqm, save_bqm_wcnf, save_bqm_binary,
+                         save_wcnf_binary)
 
 
 class AKMaxSATSolver(dimod.Sampler):
@@ -12,7 +13,11 @@ class AKMaxSATSolver(dimod.Sampler):
 
     def __init__(self):
         self._properties = {}
-        self._parameters = {}
+        self._parameters = {'cancel_token': [], 'verbose': [], 'threads': [],
+                            'portfolio': [], 'config': [], 'time_limit': [],
+                            'node_limit': [], 'target_cost': [],
+                            'warm_start': [], 'initial_state': [],
+                            'upper_bound': []}
 
     @property
     def properties(self):
@@ -22,100 +27,130 @@ class AKMaxSATSolver(dimod.Sampler):
     def parameters(self):
         return self._parameters
 
+    @staticmethod
+    def _limits(time_limit, node_limit, target_cost, offset=0):
+        """ Keyword arguments of the solve functions for the limits """
+        return {'time_limit': time_limit or 0.0,
+                'node_limit': node_limit or 0,
+                'target_cost': (float('-inf') if target_cost is None
+                                else target_cost - offset)}
+
     @staticmethod
     def max_precision(bqm):
-        max_abs_coeff = np.max(np.abs(bqm.to_numpy_matrix()))
+        linear, (_, _, quadratic), _ = bqm.to_numpy_vectors()
+        max_abs_coeff = max(np.max(np.abs(linear), initial=0),
+                            np.max(np.abs(quadratic), initial=0))
         precision = 10 ** (np.floor(np.log10(max_abs_coeff)) - 4)
         return precision
 
-    def sample_ising(self, h, J):
+    def sample_ising(self, h, J, **parameters):
         bqm = dimod.BinaryQuadraticModel.from_ising(h, J)
-        return self.sample(bqm)
+        return self.sample(bqm, **parameters)
 
-    def sample_qubo(self, Q):
+    def sample_qubo(self, Q, **parameters):
         bqm = dimod.BinaryQuadraticModel.from_qubo(Q)
-        return self.sample(bqm)
-
-    def sample(self, bqm):
+        return self.sample(bqm, **parameters)
+
+    def sample(self, bqm, cancel_token=None, verbose=False, threads=1,
+               portfolio=0, config='default', time_limit=None,
+               node_limit=None, target_cost=None, warm_start=0.01,
+               initial_state=None, upper_bound=None):
+        """ Solve bqm to optimality, see the README for details
+
+        cancel_token: CancelToken which stops the search with RuntimeError
+        verbose: print the solver progress to stdout
+        threads: number of search threads, 0 for one per hardware thread
+        portfolio: number of differently configured searches to race
+        config: 'default', 'fuip', 'gup', 'rbfs' or 'rbfs_prop_list'
+        time_limit: stop after this many seconds
+        node_limit: stop after this many search nodes
+        target_cost: stop at a sample with at most this energy
+        warm_start: seconds of tabu search before the search, 0 for none
+        initial_state: known sample to start from
+        upper_bound: only search for samples with a lower energy
+        """
         if bqm.num_interactions == 0:
             raise Exception('Only problem with interactions is solvable')
 
-        label_mappings = {label: i for i, label in enumerate(sorted(bqm.variables))}
-        bqm_relabeled = bqm.relabel_variables(label_mappings, inplace=False)
-        _bqm = bqm_relabeled.change_vartype(dimod.BINARY, inplace=False)
-
-        linear = [v for i, v in sorted(_bqm.linear.items(), key=lambda x: x[0])]
-        quadratic = [[i, j, v] for (i, j), v in _bqm.quadratic.items()]
+        variables = sorted(bqm.variables)
+        _bqm = bqm.change_vartype(dimod.BINARY, inplace=False)
+        linear, (row, col, quadratic), offset = _bqm.to_numpy_vectors(
+            variable_order=variables)
 
-        file_ID, filename = tempfile.mkstemp()
-        try:
-            precision = AKMaxSATSolver.max_precision(_bqm)
-            with os.fdopen(file_ID, 'w') as f:
-                AKMaxSATSolver.convert_to_wcnf(linear, quadratic, f, precision)
-            raw_solution = solve_qubo(filename)
-        finally:
-            os.remove(filename)
+        if initial_state is None:
+            initial = []
+        else:
+            if isinstance(initial_state, dimod.SampleSet):
+                initial_state = initial_state.first.sample
+            # variables which are 1 in BINARY or SPIN are false literals
+            initial = [-1 if initial_state[v] == 1 else 1 for v in variables]
+
+        result = solve_bqm(linear, row, col, quadratic,
+                           cancel_token=cancel_token, verbose=verbose,
+                           threads=threads, portfolio=portfolio,
+                           config=config, warm_start=warm_start,
+                           initial_state=np.array(initial, dtype=np.int32),
+                           upper_bound=(float('inf') if upper_bound is None
+                                        else upper_bound - offset),
+                           **self._limits(time_limit, node_limit, target_cost,
+                                          offset))
+        if not result.solution:
+            if result.optimal:
+                raise ValueError('no sample has energy below upper_bound')
+            raise RuntimeError('no sample found within the limits')
+        raw_solution = result.solution
 
         if bqm.vartype == dimod.BINARY:
             solution = np.where(np.array(raw_solution) == -1, 1, 0)
         elif bqm.vartype == dimod.SPIN:
             solution = np.where(np.array(raw_solution) == -1, 1, -1)
 
-        sampleset = dimod.SampleSet.from_samples_bqm(np.array(solution), bqm_relabeled)
-        label_mappings = {v: k for k, v in label_mappings.items()}
-        return sampleset.relabel_variables(label_mappings, inplace=False)
+        info = {'optimal': result.optimal,
+                'lower_bound': result.lower_bound + offset}
+        return dimod.SampleSet.from_samples_bqm((solution, variables), bqm,
+                                                info=info)
 
     @staticmethod
     def convert_to_wcnf(linear, quadratic, file, precision):
-        linear_corr = np.round(np.array(linear) / precision)
-
-        _linear = {}
-        for i, _ in enumerate(linear):
-            if linear_corr[i] == 0:
-                continue
-            _linear[-np.sign(linear_corr[i]) * (i + 1)] = np.abs(linear_corr[i])
-
-        _linear_reduced = {}
-        for i, _ in enumerate(linear):
-            weight = _linear.get(i, 0) - _linear.get(-i, 0)
-            if weight > 0:
-                _linear_reduced[i] = weight
-            elif weight < 0:
-                _linear_reduced[-i] = -weight
-
-        num_variables = len(linear)
-        num_clauses = len(_linear_reduced)
-
-        if quadratic:
-            quadratic_corr = np.round(np.array(quadratic)[:, 2] / precision)
-            _quadratic = {}
-            for edge, _ in enumerate(quadratic):
-                i = quadratic[edge][0] + 1
-                j = quadratic[edge][1] + 1
-
-                if quadratic[edge][2] > 0:
-                    _quadratic[(-i, -j)] = _quadratic.get((i, j), 0) + quadratic_corr[edge]
-                elif quadratic[edge][2] < 0:
-                    _linear[i] = _linear.get(-i, 0) - quadratic_corr[edge]
-                    _quadratic[(-i, j)] = _quadratic.get((i, -j), 0) - quadratic_corr[edge]
-
-            num_clauses += len(_quadratic)
-
-        file.write("p wcnf %d %d\n" % (num_variables, num_clauses))
-        for i, v in _linear_reduced.items():
-            if v == 0:
-                continue
-            file.write("%d %d 0\n" % (v, -i))
-
-        if quadratic:
-            for (i, j), v in _quadratic.items():
-                if v == 0:
-                    continue
-                file.write("%d %d %d 0\n" % (v, -i, -j))
-
-    def sample_wcnf(self, filename):
+        """ Write a QUBO given as [i, j, value] triples to a wcnf file """
+        quadratic = np.array(quadratic, dtype=float).reshape(-1, 3)
+        file_ID, filename = tempfile.mkstemp()
+        os.close(file_ID)
+        try:
+            save_bqm_wcnf(filename, np.array(linear, dtype=float),
+                          quadratic[:, 0].astype(np.int32),
+                          quadratic[:, 1].astype(np.int32), quadratic[:, 2],
+                          precision)
+            with open(filename) as f:
+                file.write(f.read())
+        finally:
+            os.remove(filename)
+
+    def sample_wcnf(self, filename, cancel_token=None, verbose=False,
+                    threads=1, portfolio=0, config='default', time_limit=None,
+                    node_limit=None, target_cost=None, warm_start=0.01,
+                    initial_state=None, upper_bound=None):
+        """ Solve a wcnf file, returns the best assignment found
+
+        The file may be compressed with gzip or xz (see
+        ``supported_compressions()``) or be in binary format. The other
+        parameters are those of ``sample``; ``initial_state`` is an
+        assignment in the format of the result.
+        """
         if os.path.isfile(filename):
-            return solve_qubo(filename)
+            initial = [] if initial_state is None else initial_state
+            result = solve_qubo(filename, cancel_token=cancel_token,
+                                verbose=verbose, threads=threads,
+                                portfolio=portfolio, config=config,
+                                warm_start=warm_start,
+                                initial_state=np.array(initial,
+                                                       dtype=np.int32),
+                                upper_bound=(float('inf')
+                                             if upper_bound is None
+                                             else upper_bound),
+                                **self._limits(time_limit, node_limit,
+                                               target_cost))
+            return result.solution
         else:
             raise ValueError('not found: %s' % filename)
 
@@ -124,15 +159,24 @@ class AKMaxSATSolver(dimod.Sampler):
 AKMaxSATSampler = AKMaxSATSolver
 
 
-def save_wcnf(bqm, filename, precision=1e-6):
+def save_wcnf(bqm, filename, precision=None):
     """ Save bqm to a wcnf file which has dimacs format """
-    label_mappings = {label: i for i, label in enumerate(sorted(bqm.variables))}
-    bqm_relabeled = bqm.relabel_variables(label_mappings, inplace=False)
-    _bqm = bqm_relabeled.change_vartype(dimod.BINARY, inplace=False)
+    _bqm = bqm.change_vartype(dimod.BINARY, inplace=False)
+    linear, (row, col, quadratic), _ = _bqm.to_numpy_vectors(
+        variable_order=sorted(bqm.variables))
+    save_bqm_wcnf(filename, linear, row, col, quadratic, precision or 0.0)
+
+
+def save_binary(bqm, filename, precision=None):
+    """ Save bqm to a file in binary format, which loads faster than wcnf """
+    _bqm = bqm.change_vartype(dimod.BINARY, inplace=False)
+    linear, (row, col, quadratic), _ = _bqm.to_numpy_vectors(
+        variable_order=sorted(bqm.variables))
+    save_bqm_binary(filename, linear, row, col, quadratic, precision or 0.0)
 
-    linear = [v for i, v in sorted(_bqm.linear.items(), key=lambda x: x[0])]
-    quadratic = [[i, j, v] for (i, j), v in _bqm.quadratic.items()]
 
-    precision = AKMaxSATSolver.max_precision(_bqm)
-    with open(filename, 'w') as f:
-        AKMaxSATSolver.convert_to_wcnf(linear, quadratic, f, precision)
+def wcnf_to_binary(wcnf_filename, filename):
+    """ Convert a wcnf file to a file in binary format """
+    if not os.path.isfile(wcnf_filename):
+        raise ValueError('not found: %s' % wcnf_filename)
+    save_wcnf_binary(filename, wcnf_filename)
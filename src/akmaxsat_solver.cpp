@@ -1,28 +1,734 @@
 #include "akmaxsat_solver.hpp"
 
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "akmaxsat.hpp"
+#include "binary_instance.hpp"
+#include "preprocessor.hpp"
+#include "qubo.hpp"
+#include "roof_duality.hpp"
+#include "wcnf_instance.hpp"
 
 using namespace std;
 
-vector<int> solve_qubo(string filename) {
-    srand(time(0));
+//! poll Python signal handlers; only called from the main thread
+static bool check_signals(void *) {
+    py::gil_scoped_acquire acquire;
+    return PyErr_CheckSignals() != 0;
+}
 
-    ifstream istr(filename);
-    CNF_Formula<long long> cf(istr);
+//! options of a single solve
+struct SolveOptions {
+    bool verbose;
+    int threads;
+    int portfolio;
+    string config;
+    double time_limit;
+    long long node_limit;
+    double target_cost;
+    double warm_start;
+    //! value of variable i at index i, as in SolveResult::solution; empty
+    //! if no initial assignment was given
+    vector<char> initial_state;
+    //! only assignments cheaper than this are searched for
+    ULL upper_bound;
+};
 
-#ifdef RBFS
-    rbfs(cf);
-#else
-    fast_backtrack(cf);
-#endif
+//! set up the early termination control of a solve; needs the GIL
+static SearchControl make_control(CancelToken *token,
+                                  const SolveOptions &opt) {
+    SearchControl control;
+    if (token != NULL) control.cancel_flag = &token->flag;
+    if (opt.time_limit > 0) control.setTimeLimit(opt.time_limit);
+    if (opt.node_limit > 0) control.node_limit = opt.node_limit;
+    py::module threading = py::module::import("threading");
+    if (threading.attr("current_thread")().is(
+            threading.attr("main_thread")()))
+        control.check = check_signals;
+    return control;
+}
+
+//! convert a target cost to SearchControl::target_cost
+/*! \param target the target in units of the formula weights, which is
+ *  unreachable if it is negative or NaN
+ */
+static ULL target_weight(double target) {
+    if (!(target >= 0)) return 0;
+    if (target >= (double)(MAXWEIGHT - 1)) return MAXWEIGHT;
+    return (ULL)floor(target) + 1;
+}
+
+//! convert an upper bound to the bound of the branch and bound
+/*! \param bound the bound in units of the formula weights, which excludes
+ *  every assignment if it is not positive and none if it is infinite
+ */
+static ULL bound_weight(double bound) {
+    if (!(bound > 0)) return 0;
+    if (bound >= (double)MAXWEIGHT) return MAXWEIGHT;
+    return (ULL)ceil(bound);
+}
+
+//! raise the Python exception of a cancelled solve; needs the GIL
+static void check_interrupted(const SearchControl &control) {
+    if (!control.interrupted || control.limit_reached) return;
+    if (PyErr_Occurred()) throw py::error_already_set();
+    throw runtime_error("search cancelled");
+}
+
+// the configurations which can be selected by name besides "default"; they
+// correspond to the sets of preprocessor switches listed in CMakeLists.txt
+// (template arguments: Fuip, CalcMh, BestFirst, PropList, UseGup, Stats)
+typedef SolverConfig<true, true, false, false, false, false> FuipConfig;
+typedef SolverConfig<true, true, false, false, true, false> GupConfig;
+typedef SolverConfig<true, true, true, false, true, false> RbfsConfig;
+typedef SolverConfig<true, true, true, true, true, false> RbfsPropListConfig;
+
+//! the formulas which the members of a portfolio search, starting with
+//! Formula; formulas which ignore their configuration, such as QuboFormula,
+//! only differ by the strategies of the members
+template <class Formula>
+struct PortfolioConfigs {
+    static vector<MemberFactory> get() {
+        return vector<MemberFactory>(1, newMember<Formula>);
+    }
+};
+
+//! the members of a portfolio on a CNF_Formula run the selected and then
+//! the other depth-first configurations; the recursive best-first search
+//! cannot take the bound shared by the members
+template <class Config>
+struct PortfolioConfigs<CNF_Formula<long long, Config> > {
+    static vector<MemberFactory> get() {
+        vector<MemberFactory> configs;
+        if (!Config::bestFirst)
+            configs.push_back(newMember<CNF_Formula<long long, Config> >);
+        add<DefaultConfig>(configs);
+        add<FuipConfig>(configs);
+        add<GupConfig>(configs);
+        return configs;
+    }
+    template <class Other>
+    static void add(vector<MemberFactory> &configs) {
+        if (!is_same<Config, Other>::value)
+            configs.push_back(newMember<CNF_Formula<long long, Other> >);
+    }
+};
+
+//! output sink and random number generator of a single solve
+static SolverContext make_context(bool verbose) {
+    return SolverContext(verbose ? stdout : NULL, random_device()());
+}
+
+//! collect the result of a search in units of the formula weights
+/*! \param cf the formula with the best assignment, or the portfolio member
+ *  which found it
+ *  \param completed false if the search was stopped early
+ *  \param initial true if an initial assignment was given
+ */
+template <class Formula>
+static SolveResult collect_result(const Formula &cf, bool completed,
+                                  bool initial, const SolveOptions &opt) {
+    SolveResult result;
+    ULL cost = cf.getSolutionCost();
+    // a formula without variables has an assignment regardless of the bound
+    bool found = cost < cf.getHardWeight() &&
+                 (initial || cost < opt.upper_bound);
+    ULL lb = cf.getLowerBound();
+    // a complete search proves that nothing is cheaper than the best
+    // assignment found or the upper bound
+    if (completed) lb = max(lb, min(cost, opt.upper_bound));
+    // a budget may run out just after the best assignment was proven optimal
+    result.optimal = found ? cost <= lb : completed;
+    if (result.optimal) cf.printSolution();
+    if (found) result.solution = cf.getSolution();
+    result.cost = found ? (double)cost : HUGE_VAL;
+    result.lower_bound = result.optimal && found ? (double)cost : (double)lb;
+    return result;
+}
+
+//! run the search on a Formula and collect its result in units of the
+//! formula weights
+template <class Config, class Formula>
+static SolveResult solve_formula(const WcnfInstance &inst,
+                                 const SolveOptions &opt,
+                                 SearchControl &control) {
+    unique_ptr<Formula> cf;
+    bool completed;
+    int threads = opt.threads;
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+    SolverContext ctx = make_context(opt.verbose);
+    // the recursive best-first search does not use an initial upper bound
+    if (Config::bestFirst &&
+        (!opt.initial_state.empty() || opt.upper_bound < MAXWEIGHT))
+        throw invalid_argument(
+            "initial_state and upper_bound need a depth-first config");
+    Assignment initial;
+    const Assignment *init = NULL;
+    if (!opt.initial_state.empty()) {
+        if ((int)opt.initial_state.size() != inst.maxVn)
+            throw invalid_argument("initial_state has the wrong size");
+        initial.values.push_back(0);
+        initial.values.insert(initial.values.end(), opt.initial_state.begin(),
+                              opt.initial_state.end());
+        initial.cost = evaluate(inst, initial.values);
+        init = &initial;
+    }
+    Assignment start;
+    const Assignment *warm = NULL;
+    if (!Config::bestFirst && opt.warm_start > 0) {
+        chrono::steady_clock::time_point deadline =
+            chrono::steady_clock::now() +
+            chrono::duration_cast<chrono::steady_clock::duration>(
+                chrono::duration<double>(opt.warm_start));
+        if (local_search(inst, max(threads, opt.portfolio),
+                         min(deadline, control.deadline), ctx, start, init))
+            warm = &start;
+    }
+    // without an initial assignment only assignments below the upper bound
+    // are returned
+    if (init == NULL && warm != NULL && warm->cost >= opt.upper_bound)
+        warm = NULL;
+    if (init != NULL && (!inst.hard || init->cost < inst.hard) &&
+        (warm == NULL || init->cost < warm->cost))
+        warm = init;
+    // branch on the values of the best assignment known first, which starts
+    // out as the initial assignment or the one local search improved it to
+    SearchStrategy strategy;
+    strategy.guided = init != NULL;
+    // the recursive best-first search has no parallel mode
+    if (!Config::bestFirst && opt.portfolio > 1) {
+        unique_ptr<PortfolioMember> best;
+        completed = portfolio_backtrack(
+            inst, opt.portfolio, PortfolioConfigs<Formula>::get(), ctx.fork(),
+            &control, best, warm, opt.upper_bound, strategy);
+        return collect_result(*best, completed, init != NULL, opt);
+    }
+    if (!Config::bestFirst && threads > 1)
+        completed = parallel_backtrack(inst, threads, ctx.fork(), &control,
+                                       cf, warm, opt.upper_bound, strategy);
+    else {
+        cf.reset(new Formula(inst, ctx.fork()));
+        if (warm != NULL) cf->saveBest(*warm);
+        cf->setUpperBound(opt.upper_bound);
+        completed = backtrack(*cf, &control, strategy);
+    }
+    return collect_result(*cf, completed, init != NULL, opt);
+}
+
+//! run the search on a connected formula and collect its result in units
+//! of the formula weights
+template <class Config>
+static SolveResult solve_connected(const WcnfInstance &inst,
+                                   const SolveOptions &opt,
+                                   SearchControl &control) {
+    // formulas without clauses of more than two literals, such as encoded
+    // QUBOs, are searched on their implication graph
+    if (!Config::bestFirst &&
+        (inst.lengths.empty() ||
+         *max_element(inst.lengths.begin(), inst.lengths.end()) <= 2))
+        return solve_formula<Config, QuboFormula<Config> >(inst, opt, control);
+    return solve_formula<Config, CNF_Formula<long long, Config> >(inst, opt,
+                                                                  control);
+}
+
+//! run the search on the connected components of a formula and add up
+//! their results
+/*! The components are searched one after another, smallest first; each
+ * search is bounded by the upper bound minus the costs of the components
+ * solved before it, and gets an equal share of the remaining time.
+ */
+template <class Config>
+static SolveResult solve_components(const WcnfInstance &inst,
+                                    const SolveOptions &opt,
+                                    SearchControl &control) {
+    vector<WcnfInstance> parts;
+    vector<vector<int> > vars;
+    int n = splitComponents(inst, parts, vars);
+    if (n <= 1) return solve_connected<Config>(inst, opt, control);
+    if (!opt.initial_state.empty() &&
+        (int)opt.initial_state.size() != inst.maxVn)
+        throw invalid_argument("initial_state has the wrong size");
+    make_context(opt.verbose).print("c %d connected components\n", n);
+    SolveResult result;
+    // variables which occur in no clause keep their initial value
+    vector<int> solution(inst.maxVn, 1);
+    for (int i = 0; i < (int)opt.initial_state.size(); ++i)
+        solution[i] = opt.initial_state[i];
+    ULL cost = 0;
+    bool found = true;
+    result.optimal = true;
+    for (int k = 0; k < n; ++k) {
+        SolveOptions part = opt;
+        if (!opt.initial_state.empty())
+            for (int i = 0; i < parts[k].maxVn; ++i)
+                part.initial_state[i] = opt.initial_state[vars[k][i] - 1];
+        part.initial_state.resize(opt.initial_state.empty() ? 0
+                                                            : parts[k].maxVn);
+        part.warm_start = opt.warm_start * parts[k].nClauses() /
+                          max(1, inst.nClauses());
+        if (opt.upper_bound < MAXWEIGHT)
+            part.upper_bound = opt.upper_bound - min(cost, opt.upper_bound);
+        SearchControl partControl = control;
+        // a budget which ran out for an earlier component is renewed by the
+        // share of the remaining time
+        partControl.interrupted = partControl.limit_reached = false;
+        // the target can only be reached with the last component
+        partControl.target_cost = 0;
+        if (k == n - 1 && control.target_cost > cost)
+            partControl.target_cost = control.target_cost - cost;
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if (control.deadline != chrono::steady_clock::time_point::max() &&
+            control.deadline > now)
+            partControl.deadline = now + (control.deadline - now) / (n - k);
+        SolveResult r = solve_connected<Config>(parts[k], part, partControl);
+        if (partControl.interrupted && !partControl.limit_reached) {
+            // the solve was cancelled
+            control.interrupted = true;
+            control.limit_reached = false;
+            result.optimal = false;
+            found = false;
+            break;
+        }
+        if (partControl.limit_reached)
+            control.interrupted = control.limit_reached = true;
+        result.optimal = result.optimal && r.optimal;
+        result.lower_bound += r.lower_bound;
+        found = !r.solution.empty();
+        if (!found) break;
+        vector<char> values(parts[k].maxVn + 1, 0);
+        for (int i = 0; i < parts[k].maxVn; ++i) {
+            values[i + 1] = (char)r.solution[i];
+            solution[vars[k][i] - 1] = r.solution[i];
+        }
+        cost += evaluate(parts[k], values);
+    }
+    if (found) {
+        result.solution = solution;
+        result.cost = (double)cost;
+        if (result.optimal) result.lower_bound = (double)cost;
+    } else
+        result.cost = HUGE_VAL;
+    return result;
+}
+
+//! options for the search on a formula whose costs are those of the input
+//! minus constant; the target of control is lowered accordingly
+static SolveOptions shift_options(const SolveOptions &opt, ULL constant,
+                                  SearchControl &control) {
+    SolveOptions rest = opt;
+    if (opt.upper_bound < MAXWEIGHT)
+        rest.upper_bound = opt.upper_bound - min(constant, opt.upper_bound);
+    control.target_cost =
+        control.target_cost > constant ? control.target_cost - constant : 0;
+    return rest;
+}
+
+//! run the search on a formula reduced by roof duality and collect its
+//! result in units of the formula weights
+/*! Formulas without clauses of more than two literals, such as encoded
+ * QUBOs, are reduced by roof duality first: the variables it fixes are
+ * substituted, so that they do not occur in the formula which is searched.
+ */
+template <class Config>
+static SolveResult solve_roof_duality(const WcnfInstance &inst,
+                                      const SolveOptions &opt,
+                                      SearchControl &control) {
+    ULL total = 0;
+    bool quadratic = true;
+    for (int i = 0; i < inst.nClauses() && quadratic; ++i) {
+        quadratic = inst.lengths[i] <= 2 && inst.weights[i] < (1ULL << 62);
+        total += min(inst.weights[i], (1ULL << 62) - total);
+        quadratic = quadratic && total < (1ULL << 62);
+    }
+    if (!quadratic || inst.maxVn == 0)
+        return solve_components<Config>(inst, opt, control);
+    WcnfInstance reduced;
+    vector<char> fixed;
+    ULL constant;
+    ULL bound = roofDuality(inst, reduced, fixed, constant);
+    int nFixed = inst.maxVn - (int)count(fixed.begin() + 1, fixed.end(), 0);
+    make_context(opt.verbose)
+        .print("c roof duality: lower bound %llu, %d of %d variables fixed\n",
+               bound, nFixed, inst.maxVn);
+    // if the fixed values violate hard clauses, every assignment does; the
+    // whole formula is searched to report this
+    if (nFixed == 0 || (inst.hard && constant >= inst.hard))
+        return solve_components<Config>(inst, opt, control);
+    SolveResult result = solve_components<Config>(
+        reduced, shift_options(opt, constant, control), control);
+    if (!result.solution.empty()) {
+        for (int v = 1; v <= inst.maxVn; ++v)
+            if (fixed[v]) result.solution[v - 1] = fixed[v];
+        result.cost += (double)constant;
+    }
+    result.lower_bound =
+        max(result.lower_bound + (double)constant, (double)bound);
+    if (!result.solution.empty() && result.cost <= result.lower_bound) {
+        result.optimal = true;
+        result.lower_bound = result.cost;
+    }
+    return result;
+}
+
+//! run the search and collect its result in units of the formula weights
+/*! Formulas with hard clauses or longer clauses are simplified by the
+ * Preprocessor first, and the solution of the simplified formula is
+ * completed to the variables it set or eliminated.
+ */
+template <class Config>
+static SolveResult solve(const WcnfInstance &inst, const SolveOptions &opt,
+                         SearchControl &control) {
+    // roof duality sets the pure literals of encoded QUBOs as well
+    if (!inst.hard &&
+        (inst.lengths.empty() ||
+         *max_element(inst.lengths.begin(), inst.lengths.end()) <= 2))
+        return solve_roof_duality<Config>(inst, opt, control);
+    Preprocessor pre(inst);
+    pre.run();
+    WcnfInstance reduced;
+    ULL constant = pre.getFormula(reduced);
+    make_context(opt.verbose)
+        .print("c preprocessing: %d of %d clauses left\n",
+               reduced.nClauses(), inst.nClauses());
+    if (!pre.wasChanged())
+        return solve_roof_duality<Config>(inst, opt, control);
+    // if the clauses which became empty are hard, the formula has no
+    // feasible assignment
+    if (inst.hard && constant >= inst.hard) {
+        SolveResult result;
+        result.cost = HUGE_VAL;
+        result.lower_bound = (double)inst.hard;
+        result.optimal = true;
+        return result;
+    }
+    SolveResult result = solve_roof_duality<Config>(
+        reduced, shift_options(opt, constant, control), control);
+    if (!result.solution.empty()) {
+        vector<char> values(1, 0);
+        values.insert(values.end(), result.solution.begin(),
+                      result.solution.end());
+        pre.reconstruct(values);
+        for (int v = 1; v <= inst.maxVn; ++v)
+            result.solution[v - 1] = values[v];
+        result.cost += (double)constant;
+    }
+    result.lower_bound += (double)constant;
+    if (result.optimal && !result.solution.empty())
+        result.lower_bound = result.cost;
+    return result;
+}
 
-    cf.printSolution();
+//! run the solver configuration named opt.config; needs no GIL
+static SolveResult solve(const WcnfInstance &inst, const SolveOptions &opt,
+                         SearchControl &control) {
+    if (opt.config == "default")
+        return solve<DefaultConfig>(inst, opt, control);
+    if (opt.config == "fuip") return solve<FuipConfig>(inst, opt, control);
+    if (opt.config == "gup") return solve<GupConfig>(inst, opt, control);
+    if (opt.config == "rbfs") return solve<RbfsConfig>(inst, opt, control);
+    if (opt.config == "rbfs_prop_list")
+        return solve<RbfsPropListConfig>(inst, opt, control);
+    throw invalid_argument("unknown solver config " + opt.config);
+}
+
+//! check that name is one of the solver configurations of solve
+/*! \returns true iff the configuration searches depth-first
+ */
+static bool check_config(const string &name) {
+    if (name == "default" || name == "fuip" || name == "gup") return true;
+    if (name == "rbfs" || name == "rbfs_prop_list") return false;
+    throw invalid_argument("unknown solver config " + name);
+}
+
+//! collect the options of a solve
+static SolveOptions make_options(bool verbose, int threads, int portfolio,
+                                 const string &config, double time_limit,
+                                 long long node_limit, double target_cost,
+                                 double warm_start, int_array initial_state) {
+    check_config(config);
+    SolveOptions opt;
+    opt.verbose = verbose;
+    opt.threads = threads;
+    opt.portfolio = portfolio;
+    opt.config = config;
+    opt.time_limit = time_limit;
+    opt.node_limit = node_limit;
+    opt.target_cost = target_cost;
+    opt.warm_start = warm_start;
+    const int *values = initial_state.data();
+    for (int i = 0; i < (int)initial_state.size(); ++i) {
+        if (values[i] != 1 && values[i] != -1)
+            throw invalid_argument("initial_state must consist of 1 and -1");
+        opt.initial_state.push_back((char)values[i]);
+    }
+    opt.upper_bound = MAXWEIGHT;
+    return opt;
+}
+
+static SolveResult solve_model(const QuboModel &q, double precision,
+                               double upper_bound, CancelToken *token,
+                               SolveOptions opt) {
+    SearchControl control = make_control(token, opt);
+    SolveResult result;
+    {
+        py::gil_scoped_release release;
+        WcnfInstance inst;
+        if (!(precision > 0)) precision = q.defaultPrecision();
+        long long offset = encodeQubo(q, precision, inst);
+        control.target_cost = target_weight(
+            opt.target_cost / precision - offset + 1e-6);
+        opt.upper_bound = bound_weight(upper_bound / precision - offset - 1e-6);
+        result = solve(inst, opt, control);
+        // convert the costs to energies
+        result.cost = precision * (result.cost + offset);
+        result.lower_bound = precision * (result.lower_bound + offset);
+    }
+    check_interrupted(control);
+    return result;
+}
+
+static QuboModel coo_model(double_array linear, int_array row, int_array col,
+                           double_array quadratic) {
+    int nnz = (int)quadratic.size();
+    if (row.size() != nnz || col.size() != nnz)
+        throw invalid_argument("row, col and quadratic must have equal size");
+    QuboModel q;
+    q.assignCoo((int)linear.size(), linear.data(), nnz, row.data(), col.data(),
+                quadratic.data());
+    return q;
+}
+
+SolveResult solve_qubo(string filename, CancelToken *token, bool verbose,
+                       int threads, int portfolio, string config,
+                       double time_limit, long long node_limit,
+                       double target_cost, double warm_start,
+                       int_array initial_state, double upper_bound) {
+    SolveOptions opt =
+        make_options(verbose, threads, portfolio, config, time_limit,
+                     node_limit, target_cost, warm_start, initial_state);
+    opt.upper_bound = bound_weight(upper_bound);
+    SearchControl control = make_control(token, opt);
+    control.target_cost = target_weight(target_cost);
+    SolveResult result;
+    {
+        py::gil_scoped_release release;
+        WcnfInstance inst;
+        if (!readInstanceFile(filename, inst))
+            throw invalid_argument("cannot parse " + filename);
+        result = solve(inst, opt, control);
+    }
+    check_interrupted(control);
+    return result;
+}
+
+SolveResult solve_bqm(double_array linear, int_array row, int_array col,
+                      double_array quadratic, double precision,
+                      CancelToken *token, bool verbose, int threads,
+                      int portfolio, string config, double time_limit,
+                      long long node_limit, double target_cost,
+                      double warm_start, int_array initial_state,
+                      double upper_bound) {
+    return solve_model(coo_model(linear, row, col, quadratic), precision,
+                       upper_bound, token,
+                       make_options(verbose, threads, portfolio, config,
+                                    time_limit, node_limit, target_cost,
+                                    warm_start, initial_state));
+}
+
+SolveResult solve_qubo_csr(double_array linear, int_array indptr,
+                           int_array indices, double_array data,
+                           double precision, CancelToken *token,
+                           bool verbose, int threads, int portfolio,
+                           string config, double time_limit,
+                           long long node_limit, double target_cost,
+                           double warm_start, int_array initial_state,
+                           double upper_bound) {
+    int n = (int)linear.size();
+    if (indptr.size() != n + 1 || indices.size() != data.size())
+        throw invalid_argument("inconsistent CSR arrays");
+    QuboModel q;
+    q.assignCsr(n, linear.data(), indptr.data(), indices.data(), data.data(),
+                (int)indices.size());
+    return solve_model(q, precision, upper_bound, token,
+                       make_options(verbose, threads, portfolio, config,
+                                    time_limit, node_limit, target_cost,
+                                    warm_start, initial_state));
+}
+
+//! problems of a batch with up to this many variables are searched
+//! directly on the formula of their worker
+static const int BATCH_DIRECT_VARS = 64;
+
+//! solve the QUBOs of a batch, whose coefficients are concatenated
+/*! time_limit and node_limit bound the search of each problem on its own;
+ * a problem stopped before any assignment was found keeps energy NaN, all
+ * zero values and optimal false
+ */
+BatchResult solve_batch(int_array num_variables, double_array linear,
+                        int_array num_interactions, int_array row,
+                        int_array col, double_array quadratic,
+                        double precision, CancelToken *token, int threads,
+                        string config, double time_limit,
+                        long long node_limit, double warm_start) {
+    int k = (int)num_variables.size();
+    if (num_interactions.size() != k)
+        throw invalid_argument(
+            "num_variables and num_interactions must have equal size");
+    // offsets of the coefficients of each problem
+    vector<size_t> var_start(k + 1, 0), int_start(k + 1, 0);
+    for (int i = 0; i < k; ++i) {
+        if (num_variables.data()[i] < 0 || num_interactions.data()[i] < 0)
+            throw invalid_argument("negative problem size");
+        var_start[i + 1] = var_start[i] + num_variables.data()[i];
+        int_start[i + 1] = int_start[i] + num_interactions.data()[i];
+    }
+    if ((size_t)linear.size() != var_start[k])
+        throw invalid_argument("linear must have sum(num_variables) elements");
+    if ((size_t)row.size() != int_start[k] ||
+        (size_t)col.size() != int_start[k] ||
+        (size_t)quadratic.size() != int_start[k])
+        throw invalid_argument(
+            "row, col and quadratic must have sum(num_interactions) "
+            "elements");
+    SolveOptions opt = make_options(false, 1, 0, config, time_limit,
+                                    node_limit, 0, warm_start, int_array());
+    // small problems are searched directly, without the passes of solve and
+    // the warm start, whose setup costs more than the search itself; the
+    // configuration only matters to the recursive best-first search
+    bool direct = check_config(config) && warm_start <= 0;
+    vector<int8_t> values(var_start[k], 0);
+    vector<double> energies(k, NAN);
+    unique_ptr<bool[]> optimal(new bool[k]());
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+    threads = max(1, min(threads, k));
+    atomic<int> next(0);
+    mutex m;
+    exception_ptr error;
+    {
+        py::gil_scoped_release release;
+        // each worker takes the next problem and reuses its arrays and its
+        // formula
+        auto worker = [&]() {
+            QuboModel q;
+            WcnfInstance inst;
+            unique_ptr<QuboFormula<> > cf;
+            SolverContext ctx = make_context(false);
+            try {
+                for (int i; (i = next++) < k;) {
+                    if (token != NULL && token->cancelled()) break;
+                    q.assignCoo(num_variables.data()[i],
+                                linear.data() + var_start[i],
+                                num_interactions.data()[i],
+                                row.data() + int_start[i],
+                                col.data() + int_start[i],
+                                quadratic.data() + int_start[i]);
+                    double p =
+                        precision > 0 ? precision : q.defaultPrecision();
+                    long long offset = encodeQubo(q, p, inst);
+                    // signals can only be polled from the main thread with
+                    // the GIL, so that only the cancel token is checked
+                    SearchControl control;
+                    if (token != NULL) control.cancel_flag = &token->flag;
+                    if (opt.time_limit > 0)
+                        control.setTimeLimit(opt.time_limit);
+                    if (opt.node_limit > 0)
+                        control.node_limit = opt.node_limit;
+                    SolveResult result;
+                    if (direct && q.n <= BATCH_DIRECT_VARS) {
+                        if (cf)
+                            cf->reset(inst);
+                        else
+                            cf.reset(new QuboFormula<>(inst, ctx));
+                        cf->setUpperBound(opt.upper_bound);
+                        bool completed = backtrack(*cf, &control);
+                        result = collect_result(*cf, completed, false, opt);
+                    } else
+                        result = solve(inst, opt, control);
+                    if (result.solution.empty() && q.n > 0) continue;
+                    for (int j = 0; j < q.n; ++j)
+                        values[var_start[i] + j] = result.solution[j] == -1;
+                    energies[i] = p * (result.cost + offset);
+                    optimal[i] = result.optimal;
+                }
+            } catch (...) {
+                lock_guard<mutex> lock(m);
+                if (!error) error = current_exception();
+                next = k;
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t) pool.push_back(thread(worker));
+        worker();
+        for (size_t t = 0; t < pool.size(); ++t) pool[t].join();
+    }
+    if (error) rethrow_exception(error);
+    if (token != NULL && token->cancelled())
+        throw runtime_error("search cancelled");
+    BatchResult result;
+    result.solutions = py::array_t<int8_t>(values.size(), values.data());
+    result.energies = double_array(energies.size(), energies.data());
+    result.optimal = py::array_t<bool>(k, optimal.get());
+    return result;
+}
+
+//! encode a QUBO given as coefficient arrays
+static void encode_coo(double_array linear, int_array row, int_array col,
+                       double_array quadratic, double precision,
+                       WcnfInstance &inst) {
+    QuboModel q = coo_model(linear, row, col, quadratic);
+    encodeQubo(q, precision > 0 ? precision : q.defaultPrecision(), inst);
+}
+
+void save_bqm_wcnf(string filename, double_array linear, int_array row,
+                   int_array col, double_array quadratic, double precision) {
+    WcnfInstance inst;
+    encode_coo(linear, row, col, quadratic, precision, inst);
+    ofstream ostr(filename);
+    if (!ostr) throw runtime_error("cannot open " + filename);
+    writeDimacs(ostr, inst);
+}
+
+void save_bqm_binary(string filename, double_array linear, int_array row,
+                     int_array col, double_array quadratic,
+                     double precision) {
+    WcnfInstance inst;
+    encode_coo(linear, row, col, quadratic, precision, inst);
+    if (!saveBinary(filename, inst))
+        throw runtime_error("cannot write " + filename);
+}
+
+vector<string> supported_compressions() {
+    vector<string> formats;
+#ifdef HAVE_ZLIB
+    formats.push_back("gzip");
+#endif
+#ifdef HAVE_LZMA
+    formats.push_back("xz");
+#endif
+    return formats;
+}
 
-    vector<int> solution = cf.getSolution();
-    return solution;
+void save_wcnf_binary(string filename, string input) {
+    WcnfInstance inst;
+    {
+        py::gil_scoped_release release;
+        if (!readInstanceFile(input, inst))
+            throw invalid_argument("cannot parse " + input);
+    }
+    if (!saveBinary(filename, inst))
+        throw runtime_error("cannot write " + filename);
 }
@@ -1,9 +1,84 @@
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <stdint.h>
+
+#include <atomic>
 #include <string>
 #include <vector>
 
 using namespace std;
+namespace py = pybind11;
+
+typedef py::array_t<double, py::array::c_style | py::array::forcecast>
+    double_array;
+typedef py::array_t<int, py::array::c_style | py::array::forcecast> int_array;
+
+//! flag shared with running solves to cancel them from another thread
+struct CancelToken {
+    atomic<bool> flag;
+
+    CancelToken() : flag(false) {}
+    void cancel() { flag = true; }
+    bool cancelled() const { return flag; }
+};
+
+//! result of a solve, the costs are energies for QUBO input
+struct SolveResult {
+    //! best assignment found, empty if none was found
+    vector<int> solution;
+    //! cost of solution, infinite if none was found
+    double cost;
+    //! lower bound on the cost of an optimal assignment
+    double lower_bound;
+    //! true iff solution was proven to be optimal
+    bool optimal;
+
+    SolveResult() : cost(0), lower_bound(0), optimal(false) {}
+};
+
+//! results of a batch of solves
+struct BatchResult {
+    //! values of the binary variables of all problems, one problem after
+    //! another
+    py::array_t<int8_t> solutions;
+    //! energy of the solution of each problem, NaN if none was found
+    double_array energies;
+    //! true for the problems whose solution was proven to be optimal
+    py::array_t<bool> optimal;
+};
 
-vector<int> solve_qubo(string filename);
\ No newline at end of file
+SolveResult solve_qubo(string filename, CancelToken *token, bool verbose,
+                       int threads, int portfolio, string config,
+                       double time_limit, long long node_limit,
+                       double target_cost, double warm_start,
+                       int_array initial_state, double upper_bound);
+SolveResult solve_bqm(double_array linear, int_array row, int_array col,
+                      double_array quadratic, double precision,
+                      CancelToken *token, bool verbose, int threads,
+                      int portfolio, string config, double time_limit,
+                      long long node_limit, double target_cost,
+                      double warm_start, int_array initial_state,
+                      double upper_bound);
+SolveResult solve_qubo_csr(double_array linear, int_array indptr,
+                           int_array indices, double_array data,
+                           double precision, CancelToken *token,
+                           bool verbose, int threads, int portfolio,
+                           string config, double time_limit,
+                           long long node_limit, double target_cost,
+                           double warm_start, int_array initial_state,
+                           double upper_bound);
+BatchResult solve_batch(int_array num_variables, double_array linear,
+                        int_array num_interactions, int_array row,
+                        int_array col, double_array quadratic,
+                        double precision, CancelToken *token, int threads,
+                        string config, double time_limit,
+                        long long node_limit, double warm_start);
+void save_bqm_wcnf(string filename, double_array linear, int_array row,
+                   int_array col, double_array quadratic, double precision);
+void save_bqm_binary(string filename, double_array linear, int_array row,
+                     int_array col, double_array quadratic,
+                     double precision);
+void save_wcnf_binary(string filename, string input);
+vector<string> supported_compressions();
@@ -1,9 +1,83 @@
 #include <pybind11/pybind11.h>
 
+#include <limits>
+
 #include "akmaxsat_solver.hpp"
 
 PYBIND11_MODULE(cxxakmaxsat, m) {
     m.doc() = "Python binding of AK-MaxSAT";
 
-    m.def("solve_qubo", &solve_qubo, "Solve QUBO problem");
+    py::class_<CancelToken>(m, "CancelToken",
+                            "Flag to cancel running solves from any thread")
+        .def(py::init<>())
+        .def("cancel", &CancelToken::cancel)
+        .def("cancelled", &CancelToken::cancelled);
+
+    py::class_<SolveResult>(m, "SolveResult", "Result of a solve")
+        .def_readonly("solution", &SolveResult::solution)
+        .def_readonly("cost", &SolveResult::cost)
+        .def_readonly("lower_bound", &SolveResult::lower_bound)
+        .def_readonly("optimal", &SolveResult::optimal);
+
+    py::class_<BatchResult>(m, "BatchResult", "Results of a batch of solves")
+        .def_readonly("solutions", &BatchResult::solutions)
+        .def_readonly("energies", &BatchResult::energies)
+        .def_readonly("optimal", &BatchResult::optimal);
+
+    m.def("solve_qubo", &solve_qubo, "Solve QUBO problem", py::arg("filename"),
+          py::arg("cancel_token") = nullptr, py::arg("verbose") = false,
+          py::arg("threads") = 1, py::arg("portfolio") = 0,
+          py::arg("config") = "default", py::arg("time_limit") = 0.0,
+          py::arg("node_limit") = 0,
+          py::arg("target_cost") = -numeric_limits<double>::infinity(),
+          py::arg("warm_start") = 0.01,
+          py::arg("initial_state") = int_array(),
+          py::arg("upper_bound") = numeric_limits<double>::infinity());
+    m.def("solve_bqm", &solve_bqm,
+          "Solve QUBO problem given as coefficient arrays", py::arg("linear"),
+          py::arg("row"), py::arg("col"), py::arg("quadratic"),
+          py::arg("precision") = 0.0, py::arg("cancel_token") = nullptr,
+          py::arg("verbose") = false, py::arg("threads") = 1,
+          py::arg("portfolio") = 0, py::arg("config") = "default",
+          py::arg("time_limit") = 0.0, py::arg("node_limit") = 0,
+          py::arg("target_cost") = -numeric_limits<double>::infinity(),
+          py::arg("warm_start") = 0.01,
+          py::arg("initial_state") = int_array(),
+          py::arg("upper_bound") = numeric_limits<double>::infinity());
+    m.def("solve_qubo_csr", &solve_qubo_csr,
+          "Solve QUBO problem given as CSR matrix", py::arg("linear"),
+          py::arg("indptr"), py::arg("indices"), py::arg("data"),
+          py::arg("precision") = 0.0, py::arg("cancel_token") = nullptr,
+          py::arg("verbose") = false, py::arg("threads") = 1,
+          py::arg("portfolio") = 0, py::arg("config") = "default",
+          py::arg("time_limit") = 0.0, py::arg("node_limit") = 0,
+          py::arg("target_cost") = -numeric_limits<double>::infinity(),
+          py::arg("warm_start") = 0.01,
+          py::arg("initial_state") = int_array(),
+          py::arg("upper_bound") = numeric_limits<double>::infinity());
+    m.def("solve_batch", &solve_batch,
+          "Solve many QUBO problems given as concatenated coefficient "
+          "arrays\n\n"
+          "time_limit and node_limit apply to each problem on its own, not to "
+          "the whole batch. A problem stopped before any assignment was found "
+          "has energy NaN, all-zero values and optimal False.",
+          py::arg("num_variables"), py::arg("linear"),
+          py::arg("num_interactions"), py::arg("row"), py::arg("col"),
+          py::arg("quadratic"), py::arg("precision") = 0.0,
+          py::arg("cancel_token") = nullptr, py::arg("threads") = 0,
+          py::arg("config") = "default", py::arg("time_limit") = 0.0,
+          py::arg("node_limit") = 0, py::arg("warm_start") = 0.0);
+    m.def("save_bqm_wcnf", &save_bqm_wcnf,
+          "Encode QUBO problem and save it in wcnf format", py::arg("filename"),
+          py::arg("linear"), py::arg("row"), py::arg("col"),
+          py::arg("quadratic"), py::arg("precision") = 0.0);
+    m.def("save_bqm_binary", &save_bqm_binary,
+          "Encode QUBO problem and save it in binary format",
+          py::arg("filename"), py::arg("linear"), py::arg("row"),
+          py::arg("col"), py::arg("quadratic"), py::arg("precision") = 0.0);
+    m.def("save_wcnf_binary", &save_wcnf_binary,
+          "Read a wcnf file and save it in binary format",
+          py::arg("filename"), py::arg("input"));
+    m.def("supported_compressions", &supported_compressions,
+          "Compression formats of wcnf files which this build can read");
 }
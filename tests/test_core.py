@@ -1,9 +1,17 @@
+import gzip
+import lzma
+import os
+import tempfile
+import threading
 import unittest
 
 import dimod
+import numpy as np
 from pyqubo import Array
 
-from pyakmaxsat import AKMaxSATSolver
+from pyakmaxsat import (AKMaxSATSolver, CancelToken, save_binary, save_wcnf,
+                        solve_batch, solve_qubo_csr, supported_compressions,
+                        wcnf_to_binary)
 
 
 class TestCore(unittest.TestCase):
@@ -63,6 +71,354 @@ class TestCore(unittest.TestCase):
         self.assertEqual(round(sampleset.record[0].energy, 8),
                          round(sampleset_exact.lowest().record[0].energy, 8))
 
+    def test_sample_negative_interactions(self):
+        Q = {(0, 0): 1.5, (1, 1): -2.0, (2, 2): 0.5, (3, 3): -1.0,
+             (0, 1): -3.0, (1, 2): 2.5, (2, 3): -1.5, (0, 3): 4.0}
+
+        solver = AKMaxSATSolver()
+        exact_solver = dimod.ExactSolver()
+
+        sampleset = solver.sample_qubo(Q)
+        sampleset_exact = exact_solver.sample_qubo(Q)
+        self.assertEqual(round(sampleset.first.energy, 8),
+                         round(sampleset_exact.first.energy, 8))
+
+    def test_save_wcnf(self):
+        bqm = self.create_prob_instance()
+
+        solver = AKMaxSATSolver()
+        sampleset = solver.sample(bqm)
+
+        file_ID, filename = tempfile.mkstemp()
+        os.close(file_ID)
+        try:
+            save_wcnf(bqm, filename)
+            raw_solution = solver.sample_wcnf(filename)
+        finally:
+            os.remove(filename)
+        solution = [1 if v == -1 else 0 for v in raw_solution]
+        self.assertListEqual(sampleset.record[0].sample.tolist(), solution)
+
+        # the encoder of earlier versions writes to an open file
+        variables = sorted(bqm.variables)
+        linear = [bqm.linear[v] for v in variables]
+        quadratic = [[variables.index(u), variables.index(v), value]
+                     for (u, v), value in bqm.quadratic.items()]
+        file_ID, filename = tempfile.mkstemp()
+        try:
+            with os.fdopen(file_ID, 'w') as f:
+                AKMaxSATSolver.convert_to_wcnf(
+                    linear, quadratic, f, AKMaxSATSolver.max_precision(bqm))
+            raw_solution = solver.sample_wcnf(filename)
+        finally:
+            os.remove(filename)
+        solution = [1 if v == -1 else 0 for v in raw_solution]
+        self.assertListEqual(sampleset.record[0].sample.tolist(), solution)
+
+    def test_sample_wcnf_hard(self):
+        # x3 only occurs in hard clauses and is eliminated by resolution
+        file_ID, filename = tempfile.mkstemp()
+        with os.fdopen(file_ID, 'w') as f:
+            f.write('p wcnf 4 6 100\n'
+                    '100 1 2 0\n100 -1 3 0\n100 -3 4 0\n'
+                    '4 -2 0\n2 -4 0\n1 -1 0\n')
+        try:
+            raw_solution = AKMaxSATSolver().sample_wcnf(filename)
+        finally:
+            os.remove(filename)
+        self.assertListEqual(list(raw_solution), [1, -1, 1, 1])
+
+    def test_sample_wcnf_hard_config(self):
+        # every config, rbfs included, has to skip the branches of the search
+        # which violate hard clauses
+        clauses = [(3, [1, -2, 3]), (5, [1, 5]), (10, [4, -5]),
+                   (10, [-1, -2, 5]), (10, [3, 5]), (10, [-3, -5]),
+                   (5, [-2, -4]), (10, [1, -4]), (3, [-1, 2])]
+        file_ID, filename = tempfile.mkstemp()
+        with os.fdopen(file_ID, 'w') as f:
+            f.write('p wcnf 5 9 10\n')
+            for w, c in clauses:
+                f.write('%d %s 0\n' % (w, ' '.join(map(str, c))))
+        try:
+            for config in ['default', 'fuip', 'gup', 'rbfs',
+                           'rbfs_prop_list']:
+                raw_solution = AKMaxSATSolver().sample_wcnf(filename,
+                                                            config=config)
+                cost = sum(w for w, c in clauses
+                           if all(raw_solution[abs(l) - 1] * l < 0
+                                  for l in c))
+                self.assertEqual(cost, 3)
+        finally:
+            os.remove(filename)
+
+    def test_sample_wcnf_new_format(self):
+        # no parameter line, hard clauses are marked by h
+        file_ID, filename = tempfile.mkstemp()
+        with os.fdopen(file_ID, 'w') as f:
+            f.write('c hard clauses\nh 1 2 0\nh -1 3 0\nh -3 4 0\n'
+                    'c soft clauses\n4 -2 0\n2 -4 0\n1 -1 0\n')
+        try:
+            raw_solution = AKMaxSATSolver().sample_wcnf(filename)
+        finally:
+            os.remove(filename)
+        self.assertListEqual(list(raw_solution), [1, -1, 1, 1])
+
+    def test_sample_wcnf_compressed(self):
+        text = ('p wcnf 4 6 100\n'
+                '100 1 2 0\n100 -1 3 0\n100 -3 4 0\n'
+                '4 -2 0\n2 -4 0\n1 -1 0\n').encode()
+        # the formats are optional, builds without them raise ValueError
+        formats = {'gzip': gzip.compress, 'xz': lzma.compress}
+        for compression, compress in formats.items():
+            file_ID, filename = tempfile.mkstemp()
+            with os.fdopen(file_ID, 'wb') as f:
+                f.write(compress(text))
+            try:
+                if compression in supported_compressions():
+                    raw_solution = AKMaxSATSolver().sample_wcnf(filename)
+                    self.assertListEqual(list(raw_solution), [1, -1, 1, 1])
+                else:
+                    with self.assertRaises(ValueError):
+                        AKMaxSATSolver().sample_wcnf(filename)
+            finally:
+                os.remove(filename)
+
+    def test_sample_wcnf_parse_error(self):
+        file_ID, filename = tempfile.mkstemp()
+        with os.fdopen(file_ID, 'w') as f:
+            f.write('p wcnf 2 2 10\n3 1 -2 0\n4 2 x 0\n')
+        try:
+            with self.assertRaises(ValueError):
+                AKMaxSATSolver().sample_wcnf(filename)
+        finally:
+            os.remove(filename)
+
+    def test_save_binary(self):
+        bqm = self.create_prob_instance()
+        solution = AKMaxSATSolver().sample(bqm).record[0].sample.tolist()
+
+        file_ID, filename = tempfile.mkstemp()
+        os.close(file_ID)
+        file_ID, wcnf_filename = tempfile.mkstemp()
+        os.close(file_ID)
+        try:
+            save_binary(bqm, filename)
+            raw_solution = AKMaxSATSolver().sample_wcnf(filename)
+            self.assertListEqual([1 if v == -1 else 0 for v in raw_solution],
+                                 solution)
+
+            save_wcnf(bqm, wcnf_filename)
+            wcnf_to_binary(wcnf_filename, filename)
+            raw_solution = AKMaxSATSolver().sample_wcnf(filename)
+            self.assertListEqual([1 if v == -1 else 0 for v in raw_solution],
+                                 solution)
+        finally:
+            os.remove(filename)
+            os.remove(wcnf_filename)
+
+    def test_sample_threads(self):
+        bqm = self.create_prob_instance()
+        expected = AKMaxSATSolver().sample(bqm).first.energy
+
+        energies = []
+
+        def work():
+            energies.append(AKMaxSATSolver().sample(bqm).first.energy)
+
+        threads = [threading.Thread(target=work) for _ in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertListEqual(energies, [expected] * 4)
+
+    def test_sample_parallel(self):
+        bqm = self.create_prob_instance()
+
+        solver = AKMaxSATSolver()
+        exact_solver = dimod.ExactSolver()
+
+        sampleset = solver.sample(bqm, threads=4)
+        sampleset_exact = exact_solver.sample(bqm)
+        self.assertEqual(round(sampleset.first.energy, 8),
+                         round(sampleset_exact.first.energy, 8))
+
+    def test_sample_portfolio(self):
+        bqm = self.create_prob_instance()
+
+        solver = AKMaxSATSolver()
+        exact_solver = dimod.ExactSolver()
+
+        sampleset = solver.sample(bqm, portfolio=4)
+        sampleset_exact = exact_solver.sample(bqm)
+        self.assertEqual(round(sampleset.first.energy, 8),
+                         round(sampleset_exact.first.energy, 8))
+
+    def test_sample_components(self):
+        bqm = self.create_prob_instance()
+        energy = dimod.ExactSolver().sample(bqm).first.energy
+
+        # two copies of the instance which share no variables
+        combined = bqm.copy()
+        combined.update(bqm.relabel_variables(
+            {v: v + 100 for v in bqm.variables}, inplace=False))
+        sampleset = AKMaxSATSolver().sample(combined)
+        self.assertTrue(sampleset.info['optimal'])
+        self.assertEqual(round(sampleset.first.energy, 8),
+                         round(2 * energy, 8))
+
+    def test_sample_roof_duality(self):
+        # negative interactions make the QUBO submodular, so that roof
+        # duality fixes all variables
+        Q = {(i, i): (-1) ** i * (i + 1) for i in range(12)}
+        Q.update({(i, i + 1): -2.0 for i in range(11)})
+        sampleset = AKMaxSATSolver().sample_qubo(Q)
+        sampleset_exact = dimod.ExactSolver().sample_qubo(Q)
+        self.assertTrue(sampleset.info['optimal'])
+        self.assertEqual(round(sampleset.first.energy, 8),
+                         round(sampleset_exact.first.energy, 8))
+
+    def test_sample_config(self):
+        bqm = self.create_prob_instance()
+
+        solver = AKMaxSATSolver()
+        exact_solver = dimod.ExactSolver()
+
+        sampleset_exact = exact_solver.sample(bqm)
+        for config in ['default', 'fuip', 'gup', 'rbfs', 'rbfs_prop_list']:
+            sampleset = solver.sample(bqm, config=config)
+            self.assertEqual(round(sampleset.first.energy, 8),
+                             round(sampleset_exact.first.energy, 8))
+
+        with self.assertRaises(ValueError):
+            solver.sample(bqm, config='unknown')
+
+    def test_sample_limits(self):
+        bqm = self.create_prob_instance()
+
+        solver = AKMaxSATSolver()
+        exact_solver = dimod.ExactSolver()
+        energy = exact_solver.sample(bqm).first.energy
+
+        sampleset = solver.sample(bqm, time_limit=60, node_limit=10**9)
+        self.assertTrue(sampleset.info['optimal'])
+        self.assertEqual(round(sampleset.first.energy, 8), round(energy, 8))
+        self.assertAlmostEqual(sampleset.info['lower_bound'], energy, 2)
+
+        sampleset = solver.sample(bqm, target_cost=energy + 100)
+        self.assertLessEqual(sampleset.first.energy, energy + 100)
+        self.assertLessEqual(sampleset.info['lower_bound'], energy + 1e-2)
+
+    def test_sample_warm_start(self):
+        bqm = self.create_prob_instance()
+
+        solver = AKMaxSATSolver()
+        exact_solver = dimod.ExactSolver()
+
+        sampleset_exact = exact_solver.sample(bqm)
+        for warm_start in [0, 0.1]:
+            sampleset = solver.sample(bqm, warm_start=warm_start)
+            self.assertEqual(round(sampleset.first.energy, 8),
+                             round(sampleset_exact.first.energy, 8))
+
+    def test_sample_initial_state(self):
+        bqm = self.create_prob_instance()
+
+        solver = AKMaxSATSolver()
+        exact_solver = dimod.ExactSolver()
+
+        sampleset_exact = exact_solver.sample(bqm)
+        energy = sampleset_exact.first.energy
+        sampleset = solver.sample(bqm, initial_state=sampleset_exact,
+                                  warm_start=0)
+        self.assertEqual(round(sampleset.first.energy, 8), round(energy, 8))
+
+        sampleset = solver.sample(bqm, upper_bound=energy + 1e-3)
+        self.assertEqual(round(sampleset.first.energy, 8), round(energy, 8))
+
+        with self.assertRaises(ValueError):
+            solver.sample(bqm, upper_bound=energy - 1e-3)
+
+    def test_solve_qubo_csr_invalid(self):
+        linear = np.array([1.0, -2.0, 1.0])
+        indices = np.array([1, 2])
+        data = np.array([-3.0, 2.0])
+
+        result = solve_qubo_csr(linear, np.array([0, 1, 2, 2]), indices, data)
+        self.assertEqual(result.solution, [-1, -1, 1])
+
+        for indptr in [[1, 1, 2, 2], [0, 2, 1, 2], [0, 1, 2, 3]]:
+            with self.assertRaises(ValueError):
+                solve_qubo_csr(linear, np.array(indptr), indices, data)
+        with self.assertRaises(ValueError):
+            solve_qubo_csr(linear, np.array([0, 1, 2, 2]), np.array([1, 3]),
+                           data)
+
+    def test_solve_batch(self):
+        bqm = self.create_prob_instance()
+        linear, (row, col, quadratic), offset = bqm.to_numpy_vectors(
+            variable_order=sorted(bqm.variables))
+        n, m = len(linear), len(quadratic)
+        k = 4
+
+        args = (np.full(k, n), np.tile(linear, k), np.full(k, m),
+                np.tile(row, k), np.tile(col, k), np.tile(quadratic, k))
+        energy = dimod.ExactSolver().sample(bqm).first.energy
+        for config in ('default', 'rbfs'):
+            result = solve_batch(*args, threads=2, config=config)
+            self.assertEqual(result.solutions.shape, (k * n,))
+            for i in range(k):
+                sample = result.solutions[i * n:(i + 1) * n]
+                self.assertTrue(result.optimal[i])
+                self.assertEqual(round(result.energies[i] + offset, 8),
+                                 round(energy, 8))
+                self.assertEqual(round(bqm.energy(sample), 8),
+                                 round(energy, 8))
+        with self.assertRaises(ValueError):
+            solve_batch(*args, config='unknown')
+
+    def test_solve_batch_limit(self):
+        # a dense random problem whose first descent is longer than the
+        # nodes searched before the node limit is checked
+        n = 300
+        state = [1]
+
+        def rand(k):
+            state[0] = (1103515245 * state[0] + 12345) % 2 ** 31
+            return (state[0] >> 16) % k
+
+        linear = [rand(21) - 10 for _ in range(n)]
+        pairs = [(i, j) for i in range(n) for j in range(i + 1, n)
+                 if rand(4) == 0]
+        quadratic = [rand(21) - 10 for _ in pairs]
+        row, col = zip(*pairs)
+
+        # the limits apply to each problem, so the small one is solved
+        bqm = self.create_prob_instance()
+        small, (srow, scol, squad), offset = bqm.to_numpy_vectors(
+            variable_order=sorted(bqm.variables))
+        result = solve_batch(np.array([n, len(small)]),
+                             np.concatenate([linear, small]),
+                             np.array([len(pairs), len(squad)]),
+                             np.concatenate([row, srow]),
+                             np.concatenate([col, scol]),
+                             np.concatenate([quadratic, squad]),
+                             threads=1, node_limit=1)
+        self.assertTrue(np.isnan(result.energies[0]))
+        self.assertFalse(result.optimal[0])
+        self.assertFalse(result.solutions[:n].any())
+        sample = result.solutions[n:]
+        self.assertEqual(round(result.energies[1] + offset, 8),
+                         round(bqm.energy(sample), 8))
+
+    def test_cancel_token(self):
+        bqm = self.create_prob_instance()
+        token = CancelToken()
+        token.cancel()
+
+        with self.assertRaises(RuntimeError):
+            AKMaxSATSolver().sample(bqm, cancel_token=token)
+
 
 if __name__ == '__main__':
     unittest.main()